@@ -0,0 +1,331 @@
+// auto-generated palettes header
+#ifndef BAKED_PALETTES_H
+#define BAKED_PALETTES_H
+#include <stddef.h>
+static const char charpal_arrows[] =
+"[char]\n"
+"name=\"arrows\"\n"
+"charset=\"←↑→↓↖↗↘↙\"\n"
+"shape=\"00fa10 009922 00af01 006655 00d305 003d50 008409 004890\"\n"
+;
+static const char charpal_ascii_nerd[] =
+"[char]\n"
+"name=\"ascii_nerd\"\n"
+"charset=\" .'`^\\\",:;Il!i><~+_-?][}{1)(|\\\\/*tfjrxnuvczXYUJCLQ0OZmwqpdbkhao*#MW&8%B@$\"\n"
+;
+static const char charpal_box_lines[] =
+"[char]\n"
+"name=\"box_lines\"\n"
+"charset=\"┌┐└┘─│┼├┤┴┬\"\n"
+"shape=\"003d55 00d355 553d00 55d300 00bb00 555555 55ff55 555f55 55f555 55dd00 00dd55\"\n"
+;
+static const char charpal_braille_dots[] =
+"[char]\n"
+"name=\"braille_dots\"\n"
+"charset=\"⠁⠃⠉⠛⠟⠿\"\n"
+"shape=\"900000 90b000 990000 99bb00 99fb50 99ff55\"\n"
+;
+static const char charpal_chess_pieces[] =
+"[char]\n"
+"name=\"chess_pieces\"\n"
+"charset=\"♔♕♖♗♘♙♚♛♜♝♞♟\"\n"
+"shape=\"007711 006522 443333 005522 003201 004433 00aa33 11aa44 22cc33 116644 10fa57 10aa77\"\n"
+;
+static const char charpal_greek[] =
+"[char]\n"
+"name=\"greek\"\n"
+"charset=\"αβγδεζηθικλμνξοπρστυφχψω\"\n"
+"shape=\"10cd67 87bcd6 00aa55 74bb55 01d655 79b058 01cb49 66dd55 007414 00ca44 619a44 00aaa8 00aa43 85b459 00bb55 00bb35 00abc5 00bd55 009814 00ca45 00ef99 00a999 00ee88 00cc77\"\n"
+;
+static const char charpal_heavy[] =
+"[char]\n"
+"name=\"heavy\"\n"
+"charset=\" ▁▂▃▄▅▆▇█\"\n"
+;
+static const char charpal_math_ops[] =
+"[char]\n"
+"name=\"math_ops\"\n"
+"charset=\"∑∏∫√∞≈≠≤≥\"\n"
+"shape=\"7545b5 668888 384473 068842 00ed11 00cc00 01df40 00ac56 00ca65\"\n"
+;
+static const char charpal_musical[] =
+"[char]\n"
+"name=\"musical\"\n"
+"charset=\"♩♪♫♬♭♮♯\"\n"
+"shape=\"020555 265490 38559a 489f55 207532 207601 12a820\"\n"
+;
+static const char charpal_shades[] =
+"[char]\n"
+"name=\"shades\"\n"
+"charset=\" ░▒▓█\"\n"
+;
+static const char charpal_stars[] =
+"[char]\n"
+"name=\"stars\"\n"
+"charset=\"·✦✧★✩✪✫✬✭✮\"\n"
+"shape=\"002200 009911 005511 00aa33 005522 00ff77 006633 00bb33 008833 007733\"\n"
+;
+static const char charpal_thin[] =
+"[char]\n"
+"name=\"thin\"\n"
+"charset=\" .:-=+*#%@\"\n"
+;
+static const char charpal_weather[] =
+"[char]\n"
+"name=\"weather\"\n"
+"charset=\"☀☁☂☃☄☔☕☘☼☽\"\n"
+"shape=\"119900 001379 009a01 214422 012120 119900 006534 11ff21 117700 220821\"\n"
+;
+static const struct { const char *name; const char *text; } g_char_pals[] = {
+  {"arrows", charpal_arrows},
+  {"ascii_nerd", charpal_ascii_nerd},
+  {"box_lines", charpal_box_lines},
+  {"braille_dots", charpal_braille_dots},
+  {"chess_pieces", charpal_chess_pieces},
+  {"greek", charpal_greek},
+  {"heavy", charpal_heavy},
+  {"math_ops", charpal_math_ops},
+  {"musical", charpal_musical},
+  {"shades", charpal_shades},
+  {"stars", charpal_stars},
+  {"thin", charpal_thin},
+  {"weather", charpal_weather},
+};
+static const size_t g_char_pals_count = sizeof(g_char_pals)/sizeof(g_char_pals[0]);
+static const char colpal_aurora[] =
+"[color]\n"
+"name=\"aurora\"\n"
+"codes=\"16,22,28,34,40,46,82,118,154,190\"\n"
+"\n"
+"[effect]\n"
+"index=\"floor(i*0.09 - j*0.09 + t*4) mod n\"\n"
+;
+static const char colpal_autumn_leaves[] =
+"[color]\n"
+"name=\"autumn_leaves\"\n"
+"codes=\"52,88,124,130,166,172,178,184,220,214\"\n"
+"\n"
+"[effect]\n"
+"index=\"floor(j*0.11 + t*1.8) mod n\"\n"
+;
+static const char colpal_candy_shop[] =
+"[color]\n"
+"name=\"candy_shop\"\n"
+"codes=\"197,199,201,200,206,212,219,225,231\"\n"
+"\n"
+"[effect]\n"
+"index=\"floor(i*0.1 + j*0.1 + t*3) mod n\"\n"
+;
+static const char colpal_cyberpunk[] =
+"[color]\n"
+"name=\"cyberpunk\"\n"
+"codes=\"201,198,165,129,93,57,21,51,90,129\"\n"
+"\n"
+"[effect]\n"
+"index=\"floor(j*0.12 + t*5) mod n\"\n"
+;
+static const char colpal_desert_dusk[] =
+"[color]\n"
+"name=\"desert_dusk\"\n"
+"codes=\"94,130,166,202,208,214,180,144,108\"\n"
+"\n"
+"[effect]\n"
+"index=\"floor(j*0.09 + t*2) mod n\"\n"
+;
+static const char colpal_firestorm[] =
+"[color]\n"
+"name=\"firestorm\"\n"
+"codes=\"52,88,124,160,196,202,208,214,220,226\"\n"
+"\n"
+"[effect]\n"
+"index=\"floor(i*0.12 + t*4) mod n\"\n"
+;
+static const char colpal_forest_floor[] =
+"[color]\n"
+"name=\"forest_floor\"\n"
+"codes=\"22,28,34,40,46,82,118,154,190\"\n"
+"\n"
+"[effect]\n"
+"index=\"floor(i*0.05 + j*0.05 + t*2) mod n\"\n"
+;
+static const char colpal_galaxy[] =
+"[color]\n"
+"name=\"galaxy\"\n"
+"codes=\"16,17,18,19,55,56,57,92,129,165\"\n"
+"\n"
+"[effect]\n"
+"index=\"floor((i+j)*0.04 + t*2) mod n\"\n"
+;
+static const char colpal_grayscale_smooth[] =
+"[color]\n"
+"name=\"grayscale_smooth\"\n"
+"codes=\"232,235,237,240,243,246,249,252,255\"\n"
+"\n"
+"[effect]\n"
+"index=\"floor(j*0.1) mod n\"\n"
+;
+static const char colpal_high_contrast[] =
+"[color]\n"
+"name=\"high_contrast\"\n"
+"codes=\"16,231\"\n"
+"\n"
+"[effect]\n"
+"index=\"floor(i*0.3 + j*0.3 + t*5) mod n\"\n"
+;
+static const char colpal_icewind[] =
+"[color]\n"
+"name=\"icewind\"\n"
+"codes=\"33,39,45,51,87,123,159,195,231\"\n"
+"\n"
+"[effect]\n"
+"index=\"floor(j*0.08 - t*3) mod n\"\n"
+;
+static const char colpal_lava_lamp[] =
+"[color]\n"
+"name=\"lava_lamp\"\n"
+"codes=\"88,124,160,196,202,208,214,220,226,231\"\n"
+"\n"
+"[effect]\n"
+"index=\"floor(i*0.05 + t*2 + 3*sin(t)) mod n\"\n"
+;
+static const char colpal_matrix_glow[] =
+"[color]\n"
+"name=\"matrix_glow\"\n"
+"codes=\"22,28,34,40,46,82,118,154\"\n"
+"\n"
+"[effect]\n"
+"index=\"floor(j*0.15 + t*4) mod n\"\n"
+;
+static const char colpal_mono_white[] =
+"[color]\n"
+"name=\"mono_white\"\n"
+"codes=\"15\"\n"
+"\n"
+"[effect]\n"
+"# single color (always index 0)\n"
+"index=\"0\"\n"
+;
+static const char colpal_neon_night[] =
+"[color]\n"
+"name=\"neon_night\"\n"
+"codes=\"90,91,92,93,129,165,201,200,199,198\"\n"
+"\n"
+"[effect]\n"
+"index=\"floor(j*0.07 + t*4) mod n\"\n"
+;
+static const char colpal_neon_ocean[] =
+"[color]\n"
+"name=\"neon_ocean\"\n"
+"codes=\"17,18,19,20,21,27,33,39,45,50\"\n"
+"# [effect] ignored when override is ON, kept for fallback\n"
+"[effect]\n"
+"index=\"floor(j*0.18 + t*3.0) mod n\"\n"
+;
+static const char colpal_ocean_deep[] =
+"[color]\n"
+"name=\"ocean_deep\"\n"
+"codes=\"17,18,19,20,25,30,35,40,45,50\"\n"
+"\n"
+"[effect]\n"
+"index=\"floor(i*0.06 + t*3) mod n\"\n"
+;
+static const char colpal_pastel_dream[] =
+"[color]\n"
+"name=\"pastel_dream\"\n"
+"codes=\"225,217,223,229,230,189,186,180,177\"\n"
+"\n"
+"[effect]\n"
+"index=\"floor(i*0.07 + t*1.5) mod n\"\n"
+;
+static const char colpal_peachy[] =
+"[color]\n"
+"name=\"peachy\"\n"
+"codes=\"209,215,221,216,222,223,224,230,231\"\n"
+"\n"
+"[effect]\n"
+"index=\"floor(i*0.05 + t*3) mod n\"\n"
+;
+static const char colpal_plasma_glow[] =
+"[color]\n"
+"name=\"plasma_glow\"\n"
+"codes=\"129,93,57,21,27,33,39,45,51,87\"\n"
+"\n"
+"[effect]\n"
+"index=\"floor(j*0.12 + t*3) mod n\"\n"
+;
+static const char colpal_rainbow_bands[] =
+"[color]\n"
+"name=\"rainbow_bands\"\n"
+"codes=\"21,27,33,39,45,51,50,49,48,47\"\n"
+"\n"
+"[effect]\n"
+"# diagonal bands; wrap by palette length (n)\n"
+"index=\"floor(i*0.07 + j*0.07 + t*3.0) mod n\"\n"
+;
+static const char colpal_retro_bands[] =
+"[color]\n"
+"name=\"retro_bands\"\n"
+"# Deep blue -> cyan -> teal/green sweep (xterm 256-color indices)\n"
+"# tweak to taste; 10 colors is fine\n"
+"codes=\"18,19,20,21,27,33,39,45,50,82\"\n"
+"\n"
+"[effect]\n"
+"# horizontal scanlines, sliding over time\n"
+"# j = row, i = column, t = time (seconds), n = number of colors\n"
+"# feel free to bump the multipliers\n"
+"index=\"floor(j*0.14 + t*3.2) mod n\"\n"
+;
+static const char colpal_spring_blossom[] =
+"[color]\n"
+"name=\"spring_blossom\"\n"
+"codes=\"204,205,206,207,212,218,224,229,191,155\"\n"
+"\n"
+"[effect]\n"
+"index=\"floor(i*0.05 + t*2.5) mod n\"\n"
+;
+static const char colpal_sunset[] =
+"[color]\n"
+"name=\"sunset\"\n"
+"codes=\"196,202,208,214,220,226,190,154,118\"\n"
+"\n"
+"[effect]\n"
+"# horizontal scroll through the palette\n"
+"index=\"floor(i*0.10 + t*4.0)\"\n"
+;
+static const char colpal_vintage_terminal[] =
+"[color]\n"
+"name=\"vintage_terminal\"\n"
+"codes=\"22,28,34,40,46,82,118,154,190,226\"\n"
+"\n"
+"[effect]\n"
+"index=\"floor(i*0.12 + t*1.5) mod n\"\n"
+;
+static const struct { const char *name; const char *text; } g_color_pals[] = {
+  {"aurora", colpal_aurora},
+  {"autumn_leaves", colpal_autumn_leaves},
+  {"candy_shop", colpal_candy_shop},
+  {"cyberpunk", colpal_cyberpunk},
+  {"desert_dusk", colpal_desert_dusk},
+  {"firestorm", colpal_firestorm},
+  {"forest_floor", colpal_forest_floor},
+  {"galaxy", colpal_galaxy},
+  {"grayscale_smooth", colpal_grayscale_smooth},
+  {"high_contrast", colpal_high_contrast},
+  {"icewind", colpal_icewind},
+  {"lava_lamp", colpal_lava_lamp},
+  {"matrix_glow", colpal_matrix_glow},
+  {"mono_white", colpal_mono_white},
+  {"neon_night", colpal_neon_night},
+  {"neon_ocean", colpal_neon_ocean},
+  {"ocean_deep", colpal_ocean_deep},
+  {"pastel_dream", colpal_pastel_dream},
+  {"peachy", colpal_peachy},
+  {"plasma_glow", colpal_plasma_glow},
+  {"rainbow_bands", colpal_rainbow_bands},
+  {"retro_bands", colpal_retro_bands},
+  {"spring_blossom", colpal_spring_blossom},
+  {"sunset", colpal_sunset},
+  {"vintage_terminal", colpal_vintage_terminal},
+};
+static const size_t g_color_pals_count = sizeof(g_color_pals)/sizeof(g_color_pals[0]);
+#endif /* BAKED_PALETTES_H */
@@ -0,0 +1,487 @@
+// auto-generated from functions/*.cfg — do not edit
+#ifndef BAKED_PRESETS_H
+#define BAKED_PRESETS_H
+#include <stddef.h>
+static const char preset_burning_ship[] =
+"[render]\n"
+"fps=25\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=burning_ship\n"
+"\n"
+"[fractal]\n"
+"max_iter=300\n"
+"center_x=-1.755\n"
+"center_y=-0.03\n"
+"scale=0.12\n"
+;
+static const char preset_checker[] =
+"[render]\n"
+"fps=20\n"
+"use_color=0\n"
+"charset=\"01\"\n"
+"\n"
+"[mode]\n"
+"type=expr\n"
+"\n"
+"[expr]\n"
+"value=\"sin(floor(x*8)+floor(y*8))\"\n"
+"color=\"0\"\n"
+;
+static const char preset_config[] =
+"[render]\n"
+"fps=30\n"
+"duration=-1          ; -1 = infinite\n"
+"use_color=1          ; 1=256-color, 0=mono\n"
+"width=0              ; 0 = use terminal width\n"
+"height=0             ; 0 = use terminal height\n"
+"charset=\" .:-=+*#%@\" ; ramp for mono\n"
+"\n"
+"[mode]\n"
+"type=expr            ; expr | mandelbrot | julia\n"
+"\n"
+"[expr]\n"
+"value=\"sin(6.0*(x+0.2*sin(t*0.7))+t)*cos(6.0*(y+0.2*cos(t*0.5))-t)\"\n"
+"color=\"128+127*sin(t+3.0*r)\" ; 0..255 (only used if use_color=1)\n"
+"\n"
+"[fractal]\n"
+"max_iter=200\n"
+"center_x=-0.5\n"
+"center_y=0.0\n"
+"scale=2.8\n"
+"c_re=-0.8             ; julia only\n"
+"c_im=0.156            ; julia only\n"
+;
+static const char preset_flower[] =
+"[render]\n"
+"fps=25\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=expr\n"
+"\n"
+"[expr]\n"
+"value=\"sin(5*atan2(y,x) + r*3 - t*2)\"\n"
+"color=\"128+127*sin(5*atan2(y,x) + t)\"\n"
+;
+static const char preset_gear[] =
+"[render]\n"
+"fps=30\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=expr\n"
+"\n"
+"[expr]\n"
+"value=\"sin(atan2(y,x)*8) * cos(r*4 - t*2)\"\n"
+"color=\"128+127*sin(atan2(y,x)*8)\"\n"
+;
+static const char preset_grayscott[] =
+"[render]\n"
+"fps=25\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=grayscott\n"
+"\n"
+"[sim]\n"
+"rate=240\n"
+"max_steps=32\n"
+"scale=2\n"
+"feed=0.037\n"
+"kill=0.06\n"
+"seed=7\n"
+;
+static const char preset_heart[] =
+"[render]\n"
+"fps=20\n"
+"use_color=0\n"
+"charset=\" .oO@\"\n"
+"\n"
+"[mode]\n"
+"type=expr\n"
+"\n"
+"[expr]\n"
+"value=\"(x*x + y*y - 1)*(x*x + y*y - 1)*(x*x + y*y - 1) - x*x*y*y*y\"\n"
+"color=\"0\"\n"
+;
+static const char preset_hypnotic[] =
+"[render]\n"
+"fps=30\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=expr\n"
+"\n"
+"[expr]\n"
+"value=\"sin(r*10 - t*5)\"\n"
+"color=\"128+127*sin(r*5 - t*2)\"\n"
+;
+static const char preset_julia[] =
+"[render]\n"
+"fps=25\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=julia\n"
+"\n"
+"[fractal]\n"
+"max_iter=300\n"
+"center_x=0.0\n"
+"center_y=0.0\n"
+"scale=3.2\n"
+"c_re=-0.8\n"
+"c_im=0.156\n"
+;
+static const char preset_julia_spiral[] =
+"[render]\n"
+"fps=25\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=julia\n"
+"\n"
+"[fractal]\n"
+"max_iter=400\n"
+"center_x=0.0\n"
+"center_y=0.0\n"
+"scale=3.0\n"
+"c_re=-0.70176\n"
+"c_im=-0.3842\n"
+;
+static const char preset_lissajous[] =
+"[render]\n"
+"fps=30\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=expr\n"
+"\n"
+"[expr]\n"
+"value=\"sin(3*x + t)*sin(4*y - t)\"\n"
+"color=\"128+127*sin(t + r*2.0)\"\n"
+;
+static const char preset_lyapunov[] =
+"[render]\n"
+"fps=25\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=lyapunov\n"
+"\n"
+"[fractal]\n"
+"max_iter=400\n"
+"center_x=3.0\n"
+"center_y=3.0\n"
+"scale=2.0\n"
+"\n"
+"[lyapunov]\n"
+"sequence=AB\n"
+;
+static const char preset_mandelbrot[] =
+"[render]\n"
+"fps=25\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=mandelbrot\n"
+"\n"
+"[fractal]\n"
+"max_iter=300\n"
+"center_x=-0.5\n"
+"center_y=0.0\n"
+"scale=2.8\n"
+;
+static const char preset_mandelbrot_tour[] =
+"[render]\n"
+"fps=25\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=mandelbrot\n"
+"\n"
+"[fractal]\n"
+"max_iter=300\n"
+"\n"
+"[path]\n"
+"interp=smooth\n"
+"loop=1\n"
+"key=0  -0.5 0 3.0\n"
+"key=10 -0.743643887037158704752191506114774 0.131825904205311970493132056385139 1e-5 -0.8 0.156 1200\n"
+"key=14 -0.743643887037158704752191506114774 0.131825904205311970493132056385139 1e-5 -0.8 0.156 1200\n"
+"key=20 -0.5 0 3.0 -0.8 0.156 300\n"
+;
+static const char preset_mandelbrot_zoom[] =
+"[render]\n"
+"fps=25\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=mandelbrot\n"
+"\n"
+"[fractal]\n"
+"max_iter=500\n"
+"center_x=-0.743643887037151\n"
+"center_y=0.13182590420533\n"
+"scale=0.02\n"
+;
+static const char preset_moire[] =
+"[render]\n"
+"fps=30\n"
+"use_color=0\n"
+"charset=\" .:-=+*#%@\"\n"
+"\n"
+"[mode]\n"
+"type=expr\n"
+"\n"
+"[expr]\n"
+"value=\"sin(10*x + t) + sin(10*y - t)\"\n"
+"color=\"0\"\n"
+;
+static const char preset_nebulabrot[] =
+"[render]\n"
+"fps=25\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=nebulabrot\n"
+"\n"
+"[fractal]\n"
+"max_iter=1000\n"
+"center_x=-0.4\n"
+"center_y=0\n"
+"scale=3.4\n"
+"samples=20000\n"
+;
+static const char preset_newton[] =
+"[render]\n"
+"fps=25\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=complex_iter\n"
+"\n"
+"[fractal]\n"
+"max_iter=60\n"
+"center_x=0\n"
+"center_y=0\n"
+"scale=3.2\n"
+"\n"
+"[complex]\n"
+"map=\"z - (z^3 - 1)/(3*z^2)\"\n"
+"z0=p\n"
+;
+static const char preset_plasma[] =
+"[render]\n"
+"fps=30\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=expr\n"
+"\n"
+"[expr]\n"
+"value=\"sin(6.0*(x+0.2*sin(t*0.7))+t)*cos(6.0*(y+0.2*cos(t*0.5))-t)\"\n"
+"color=\"128+127*sin(t+3.0*r)\"\n"
+;
+static const char preset_pulse[] =
+"[render]\n"
+"fps=30\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=expr\n"
+"\n"
+"[expr]\n"
+"value=\"sin(r*20 - t*10)\"\n"
+"color=\"128+127*sin(t*5)\"\n"
+;
+static const char preset_radial[] =
+"[render]\n"
+"fps=25\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=expr\n"
+"\n"
+"[expr]\n"
+"value=\"sin(r*12 - t*4)\"\n"
+"color=\"128+127*cos(r*4 + t)\"\n"
+;
+static const char preset_rain[] =
+"[render]\n"
+"fps=30\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=expr\n"
+"\n"
+"[expr]\n"
+"value=\"sin(20*x + t*5)\"\n"
+"color=\"128+127*sin(20*x + t*5)\"\n"
+;
+static const char preset_raymarch[] =
+"[render]\n"
+"fps=25\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=raymarch\n"
+"\n"
+"[raymarch]\n"
+"sdf=\"smoothmin(length(p.x,p.y-0.3*sin(t),p.z)-1, length(length(p.x,p.z)-1.6,p.y)-0.3, 0.4)\"\n"
+"camera=0 1.5 -4\n"
+"target=0 0 0\n"
+"light=-0.5 0.8 -0.6\n"
+"fov=50\n"
+"spin=0.3\n"
+"steps=96\n"
+"epsilon=0.001\n"
+"max_dist=20\n"
+;
+static const char preset_ripple[] =
+"[render]\n"
+"fps=30\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=expr\n"
+"\n"
+"[expr]\n"
+"value=\"sin(10*r - t*4)/(r+0.1)\"\n"
+"color=\"128+127*sin(r*0.5 - t)\"\n"
+;
+static const char preset_sine[] =
+"[render]\n"
+"fps=30\n"
+"use_color=0\n"
+"charset=\" .'`^\\\",:;Il!i><~+_-?][}{1)(|\\\\/*tfjrxnuvczXYUJCLQ0OZmwqpdbkhao*#MW&8%B@$\"\n"
+"\n"
+"[mode]\n"
+"type=expr\n"
+"\n"
+"[expr]\n"
+"value=\"sin(10*x - t*8.0)\"\n"
+"color=\"0\"\n"
+;
+static const char preset_spiral[] =
+"[render]\n"
+"fps=30\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=expr\n"
+"\n"
+"[expr]\n"
+"value=\"sin(r*4 + atan2(y,x)*3 - t*3)\"\n"
+"color=\"128+127*sin(r*2 - t)\"\n"
+;
+static const char preset_stairs[] =
+"[render]\n"
+"fps=20\n"
+"use_color=0\n"
+"charset=\" =|#\"\n"
+"\n"
+"[mode]\n"
+"type=expr\n"
+"\n"
+"[expr]\n"
+"value=\"sin(floor((x+y)*5))\"\n"
+"color=\"0\"\n"
+;
+static const char preset_sunburst[] =
+"[render]\n"
+"fps=30\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=expr\n"
+"\n"
+"[expr]\n"
+"value=\"sin(atan2(y,x)*10 - t*3)\"\n"
+"color=\"128+127*cos(r*6 - t)\"\n"
+;
+static const char preset_swirl[] =
+"[render]\n"
+"fps=25\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=expr\n"
+"\n"
+"[expr]\n"
+"value=\"sin(5*r + t)*cos(5*atan2(y,x))\"\n"
+"color=\"128+127*cos(r*3 + t)\"\n"
+;
+static const char preset_tornado[] =
+"[render]\n"
+"fps=30\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=expr\n"
+"\n"
+"[expr]\n"
+"value=\"sin(6*r + 3*atan2(y,x) - t*4)\"\n"
+"color=\"128+127*sin(atan2(y,x)*5 + t)\"\n"
+;
+static const char preset_vortex[] =
+"[render]\n"
+"fps=30\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=expr\n"
+"\n"
+"[expr]\n"
+"value=\"sin(r*5 + t) * sin(atan2(y,x)*5 + t)\"\n"
+"color=\"128+127*cos(atan2(y,x)*3 - t)\"\n"
+;
+static const char preset_waves[] =
+"[render]\n"
+"fps=30\n"
+"use_color=1\n"
+"\n"
+"[mode]\n"
+"type=expr\n"
+"\n"
+"[expr]\n"
+"value=\"sin(8*x + t) + sin(8*y + t)\"\n"
+"color=\"128+127*sin(t + (x+y)*2)\"\n"
+;
+static const struct { const char *name; const char *ini; } g_baked_presets[] = {
+  {"burning_ship", preset_burning_ship},
+  {"checker", preset_checker},
+  {"config", preset_config},
+  {"flower", preset_flower},
+  {"gear", preset_gear},
+  {"grayscott", preset_grayscott},
+  {"heart", preset_heart},
+  {"hypnotic", preset_hypnotic},
+  {"julia", preset_julia},
+  {"julia_spiral", preset_julia_spiral},
+  {"lissajous", preset_lissajous},
+  {"lyapunov", preset_lyapunov},
+  {"mandelbrot", preset_mandelbrot},
+  {"mandelbrot_tour", preset_mandelbrot_tour},
+  {"mandelbrot_zoom", preset_mandelbrot_zoom},
+  {"moire", preset_moire},
+  {"nebulabrot", preset_nebulabrot},
+  {"newton", preset_newton},
+  {"plasma", preset_plasma},
+  {"pulse", preset_pulse},
+  {"radial", preset_radial},
+  {"rain", preset_rain},
+  {"raymarch", preset_raymarch},
+  {"ripple", preset_ripple},
+  {"sine", preset_sine},
+  {"spiral", preset_spiral},
+  {"stairs", preset_stairs},
+  {"sunburst", preset_sunburst},
+  {"swirl", preset_swirl},
+  {"tornado", preset_tornado},
+  {"vortex", preset_vortex},
+  {"waves", preset_waves},
+};
+static const size_t g_baked_presets_count = sizeof(g_baked_presets)/sizeof(g_baked_presets[0]);
+#endif
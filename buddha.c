@@ -0,0 +1,208 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+#include "buddha.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* work is split into a fixed number of tasks, each with its own histogram,
+   so the picture does not depend on how many threads picked them up */
+#define BUDDHA_TASKS 16
+#define BUDDHA_R     2.0   // escaping c lie within |c| <= 2
+
+static uint64_t rng_next(uint64_t *s){   // splitmix64
+    uint64_t z = (*s += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z>>30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z>>27)) * 0x94d049bb133111ebull;
+    return z ^ (z>>31);
+}
+static double rng_unit(uint64_t *s){ return (double)(rng_next(s)>>11) * (1.0/9007199254740992.0); }
+
+// main cardioid and period-2 bulb never escape; most interior samples land there
+static int in_bulbs(double cr, double ci){
+    double x=cr-0.25, q=x*x + ci*ci;
+    if(q*(q+x) <= 0.25*ci*ci) return 1;
+    return (cr+1)*(cr+1) + ci*ci <= 0.0625;
+}
+
+/* iterate c, leaving the orbit in o; returns the escape iteration or 0 */
+static int orbit(double cr, double ci, int max_iter, double *o){
+    if(in_bulbs(cr,ci)) return 0;
+    double zr=0, zi=0;
+    for(int n=0;n<max_iter;n++){
+        double t = zr*zr - zi*zi + cr;
+        zi = 2*zr*zi + ci;
+        zr = t;
+        o[2*n]=zr; o[2*n+1]=zi;
+        if(zr*zr + zi*zi > 4.0) return n+1;
+    }
+    return 0;
+}
+
+// view cell a plane point falls in; the inverse of frac_pixel()
+static int plane_cell(const FracView *v, double x, double y, int *i, int *j){
+    const double ar = (double)v->h/(double)(v->w>0?v->w:1);
+    double u = (x - v->cx)/v->scale + 0.5, w = (y - v->cy)/(v->scale*ar) + 0.5;
+    if(!(u>=-0.5/v->w && w>=-0.5/v->h && u<1+0.5/v->w && w<1+0.5/v->h)) return 0;
+    *i = (int)lrint(u*(v->w>1?v->w-1:1));
+    *j = (int)lrint(w*(v->h>1?v->h-1:1));
+    return *i>=0 && *i<v->w && *j>=0 && *j<v->h;
+}
+
+// ---- importance grid ----------------------------------------------------------
+typedef struct { Buddha *b; double *hits; } GridJob;
+
+/* one orbit per grid cell, from its center: how much of it lands in view.
+   task k takes grid rows k, k+ntask, ... with its own orbit buffer */
+static void grid_task(void *ctx, int task){
+    GridJob *J=(GridJob*)ctx;
+    const FracView *v=&J->b->v;
+    const double cs = 2*BUDDHA_R/BUDDHA_GRID;
+    double *o = J->b->orbit + (size_t)2*v->max_iter*task;
+    for(int gy=task;gy<BUDDHA_GRID;gy+=J->b->ntask){
+        for(int gx=0;gx<BUDDHA_GRID;gx++){
+            double cr = -BUDDHA_R + (gx+0.5)*cs, ci = -BUDDHA_R + (gy+0.5)*cs;
+            int n = orbit(cr,ci,v->max_iter,o), in=0, i, j;
+            for(int k=0;k<n;k++){
+                in += plane_cell(v,o[2*k],o[2*k+1],&i,&j);
+                in += plane_cell(v,o[2*k],-o[2*k+1],&i,&j);
+            }
+            J->hits[gy*BUDDHA_GRID+gx] = in;
+        }
+    }
+}
+
+/* weight = hits, spread to the neighbours (the boundary is where long orbits
+   start) and mirrored about the real axis, plus a floor so no c is left out */
+static int grid_build(Buddha *b, Pool *pool){
+    const int G=BUDDHA_GRID;
+    double *hits=(double*)malloc(sizeof(double)*G*G), *w=b->cdf;
+    if(!hits) return -1;
+    GridJob J={ b, hits };
+    pool_for(pool,b->ntask,grid_task,&J);
+    double sum=0;
+    for(int y=0;y<G;y++) for(int x=0;x<G;x++){
+        double m=0;
+        for(int dy=-1;dy<=1;dy++) for(int dx=-1;dx<=1;dx++){
+            int yy=y+dy, xx=x+dx;
+            if(yy>=0 && yy<G && xx>=0 && xx<G && hits[yy*G+xx]>m) m=hits[yy*G+xx];
+        }
+        w[y*G+x]=m; sum+=m;
+    }
+    for(int y=0;y<G/2;y++) for(int x=0;x<G;x++){
+        double m=0.5*(w[y*G+x]+w[(G-1-y)*G+x]);
+        w[y*G+x]=w[(G-1-y)*G+x]=m;
+    }
+    double floor_w = sum>0 ? 0.05*sum/(G*G) : 1.0;
+    double acc=0;
+    for(int k=0;k<G*G;k++){ acc += w[k]+floor_w; w[k]=acc; }
+    free(hits);
+    return 0;
+}
+
+int buddha_reset(Buddha *b, const FracView *v, int nebula, Pool *pool){
+    if(b->valid && b->nebula==nebula && frac_view_eq(&b->v,v)) return 0;
+    const size_t n=(size_t)v->w*v->h;
+    const int chans = nebula ? 3 : 1;
+    b->valid=0;
+    double *h=(double*)realloc(b->hist,chans*n*sizeof(double));
+    if(!h) return -1;
+    b->hist=h;
+    float *part=(float*)realloc(b->part,BUDDHA_TASKS*chans*n*sizeof(float));
+    if(!part) return -1;
+    b->part=part;
+    double *o=(double*)realloc(b->orbit,(size_t)BUDDHA_TASKS*2*(v->max_iter>0?v->max_iter:1)*sizeof(double));
+    if(!o) return -1;
+    b->orbit=o;
+    if(!b->cdf && !(b->cdf=(double*)malloc(sizeof(double)*BUDDHA_GRID*BUDDHA_GRID))) return -1;
+    memset(h,0,chans*n*sizeof(double));
+    memset(part,0,BUDDHA_TASKS*chans*n*sizeof(float));
+    b->v=*v; b->nebula=nebula; b->chans=chans; b->ntask=BUDDHA_TASKS;
+    b->samples=0; b->pass=0;
+    if(grid_build(b,pool)) return -1;
+    b->valid=1;
+    return 0;
+}
+
+// ---- sampling -------------------------------------------------------------------
+typedef struct { Buddha *b; int samples; long escaped[BUDDHA_TASKS]; } StepJob;
+
+static void step_task(void *ctx, int task){
+    StepJob *J=(StepJob*)ctx;
+    Buddha *b=J->b;
+    const FracView *v=&b->v;
+    const int G=BUDDHA_GRID, max=v->max_iter;
+    const size_t cells=(size_t)v->w*v->h;
+    const double cs=2*BUDDHA_R/G, total=b->cdf[G*G-1];
+    const int limit[3] = { max, max/10>1 ? max/10 : 1, max/100>1 ? max/100 : 1 };
+    float *part = b->part + (size_t)task*b->chans*cells;
+    double *o = b->orbit + (size_t)2*max*task;
+    uint64_t rng = ((uint64_t)b->pass<<32) ^ ((uint64_t)task*0x2545f4914f6cdd1dull) ^ 0x6a09e667f3bcc909ull;
+    int count = J->samples/b->ntask + (task < J->samples % b->ntask);
+    long esc=0;
+    for(int s=0;s<count;s++){
+        // pick a grid cell by weight, then a uniform point in it
+        double u = rng_unit(&rng)*total;
+        int lo=0, hi=G*G-1;
+        while(lo<hi){ int mid=(lo+hi)/2; if(b->cdf[mid]<u) lo=mid+1; else hi=mid; }
+        double wk = b->cdf[lo] - (lo ? b->cdf[lo-1] : 0);
+        double cr = -BUDDHA_R + (lo%G + rng_unit(&rng))*cs;
+        double ci = -BUDDHA_R + (lo/G + rng_unit(&rng))*cs;
+        int n = orbit(cr,ci,max,o);
+        if(!n) continue;
+        esc++;
+        // 1/p, relative to uniform sampling, keeps the density unbiased
+        const float f = (float)(total/(G*G*wk));
+        for(int k=0;k<n;k++){
+            int i,j;
+            for(int m=0;m<2;m++){   // conj(c) has the mirrored orbit; the weights are mirrored too
+                if(!plane_cell(v,o[2*k],m ? -o[2*k+1] : o[2*k+1],&i,&j)) continue;
+                size_t at=(size_t)j*v->w+i;
+                for(int ch=0;ch<b->chans;ch++) if(n<=limit[ch]) part[ch*cells+at] += f;
+            }
+        }
+    }
+    J->escaped[task]=esc;
+}
+
+// fold every task's histogram into hist, a row per task
+static void merge_row(void *ctx, int j){
+    Buddha *b=(Buddha*)ctx;
+    const size_t cells=(size_t)b->v.w*b->v.h;
+    for(int ch=0;ch<b->chans;ch++){
+        double *h = b->hist + ch*cells + (size_t)j*b->v.w;
+        for(int t=0;t<b->ntask;t++){
+            float *p = b->part + ((size_t)t*b->chans + ch)*cells + (size_t)j*b->v.w;
+            for(int i=0;i<b->v.w;i++){ h[i]+=p[i]; p[i]=0; }
+        }
+    }
+}
+
+long buddha_step(Buddha *b, int samples, Pool *pool){
+    if(!b->valid || samples<=0) return 0;
+    StepJob J;
+    memset(&J,0,sizeof(J));
+    J.b=b; J.samples=samples;
+    pool_for(pool,b->ntask,step_task,&J);
+    pool_for(pool,b->v.h,merge_row,b);
+    b->samples += samples;
+    b->pass++;
+    long esc=0;
+    for(int t=0;t<b->ntask;t++) esc+=J.escaped[t];
+    return esc;
+}
+
+void buddha_levels(const Buddha *b, int ch, float *out){
+    const size_t cells=(size_t)b->v.w*b->v.h;
+    const double *h = b->hist + (size_t)ch*cells;
+    double max=0;
+    for(size_t k=0;k<cells;k++) if(h[k]>max) max=h[k];
+    const double s = max>0 ? 1.0/sqrt(max) : 0;
+    for(size_t k=0;k<cells;k++) out[k]=(float)(sqrt(h[k])*s);
+}
+
+void buddha_free(Buddha *b){
+    free(b->hist); free(b->part); free(b->orbit); free(b->cdf);
+    memset(b,0,sizeof(*b));
+}
@@ -0,0 +1,34 @@
+#ifndef BUDDHA_H
+#define BUDDHA_H
+#include "fractal.h"
+
+/* orbit density (buddhabrot): random c are iterated under z^2 + c and every
+   point an escaping orbit visits inside the view is counted. nebulabrot keeps
+   three counts, for orbits escaping within max_iter, max_iter/10, max_iter/100.
+   the histogram keeps growing until the view changes */
+#define BUDDHA_GRID 128   // importance grid over the c plane, BUDDHA_GRID^2 cells
+
+typedef struct {
+    FracView v;
+    int      nebula;
+    int      chans;        // 1 (buddhabrot) or 3 (nebulabrot)
+    double  *hist;         // chans * w*h, row-major per channel
+    float   *part;         // one histogram like hist per task, merged each step
+    double  *orbit;        // one max_iter orbit buffer per task
+    int      ntask;
+    double  *cdf;          // importance: running sum of cell weights
+    long     samples;      // samples taken since the view was set
+    unsigned pass;
+    int      valid;
+} Buddha;
+
+/* start over for v if it (or nebula) differ from the view held; -1 on
+   allocation failure. builds the importance grid on the pool */
+int  buddha_reset(Buddha *b, const FracView *v, int nebula, Pool *pool);
+/* add samples random orbits, split over the pool; returns the orbits that
+   escaped. the result is the same for any thread count */
+long buddha_step(Buddha *b, int samples, Pool *pool);
+/* density of channel ch at each cell scaled to 0..1 (sqrt, then by the max) */
+void buddha_levels(const Buddha *b, int ch, float *out);
+void buddha_free(Buddha *b);
+#endif
@@ -0,0 +1,376 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+#include "cexpr.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    OP_K, OP_Z, OP_C, OP_P, OP_T,
+    OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_NEG, OP_POWI, OP_POW,
+    OP_SIN, OP_COS, OP_TAN, OP_EXP, OP_LOG, OP_SQRT,
+    OP_ABS, OP_ARG, OP_CONJ, OP_RE, OP_IM
+};
+
+// ---- scalar complex helpers (constant folding and the vm share them) ------
+static void c_div(double ar, double ai, double br, double bi, double *r, double *i){
+    double d = br*br + bi*bi;
+    if(d<1e-300) d=1e-300;
+    *r = (ar*br + ai*bi)/d;
+    *i = (ai*br - ar*bi)/d;
+}
+static void c_powi(double ar, double ai, int n, double *r, double *i){
+    double xr=1, xi=0, br=ar, bi=ai;
+    int m = n<0 ? -n : n;
+    while(m){
+        if(m&1){ double t=xr*br - xi*bi; xi=xr*bi + xi*br; xr=t; }
+        double t=br*br - bi*bi; bi=2*br*bi; br=t;
+        m>>=1;
+    }
+    if(n<0) c_div(1,0,xr,xi,&xr,&xi);
+    *r=xr; *i=xi;
+}
+static void c_fn(int op, double ar, double ai, double br, double bi, double *r, double *i){
+    switch(op){
+    case OP_ADD: *r=ar+br; *i=ai+bi; break;
+    case OP_SUB: *r=ar-br; *i=ai-bi; break;
+    case OP_MUL: *r=ar*br - ai*bi; *i=ar*bi + ai*br; break;
+    case OP_DIV: c_div(ar,ai,br,bi,r,i); break;
+    case OP_NEG: *r=-ar; *i=-ai; break;
+    case OP_POW:
+        if(ar==0 && ai==0){ *r=0; *i=0; break; }
+        else {   // exp(b log a)
+            double lr=log(hypot(ar,ai)), li=atan2(ai,ar);
+            double er=br*lr - bi*li, ei=br*li + bi*lr, m=exp(er);
+            *r=m*cos(ei); *i=m*sin(ei);
+        }
+        break;
+    case OP_SIN: *r=sin(ar)*cosh(ai); *i=cos(ar)*sinh(ai); break;
+    case OP_COS: *r=cos(ar)*cosh(ai); *i=-sin(ar)*sinh(ai); break;
+    case OP_TAN: {
+        double sr=sin(ar)*cosh(ai), si=cos(ar)*sinh(ai), cr=cos(ar)*cosh(ai), ci=-sin(ar)*sinh(ai);
+        c_div(sr,si,cr,ci,r,i);
+        break;
+    }
+    case OP_EXP: { double m=exp(ar); *r=m*cos(ai); *i=m*sin(ai); break; }
+    case OP_LOG: { double m=hypot(ar,ai); *r=log(m<1e-300?1e-300:m); *i=atan2(ai,ar); break; }
+    case OP_SQRT: {
+        double m=hypot(ar,ai);
+        *r=sqrt(0.5*(m+ar));
+        *i=copysign(sqrt(0.5*(m-ar)),ai);
+        break;
+    }
+    case OP_ABS:  *r=hypot(ar,ai); *i=0; break;
+    case OP_ARG:  *r=atan2(ai,ar); *i=0; break;
+    case OP_CONJ: *r=ar; *i=-ai; break;
+    case OP_RE:   *r=ar; *i=0; break;
+    case OP_IM:   *r=ai; *i=0; break;
+    default:      *r=ar; *i=ai; break;
+    }
+}
+
+// ---- compiler: recursive descent straight to postfix code -----------------
+typedef struct {
+    const char *s;
+    CxProg *p;
+    int depth, max_depth;
+    char *err; size_t errsz;
+    int failed;
+} Cc;
+
+typedef struct { int start; int konst; } Frag;   // konst: code is a single OP_K
+
+static void cc_fail(Cc *c, const char *msg){
+    if(c->failed) return;
+    if(*c->s) snprintf(c->err,c->errsz,"%s near '%.12s'",msg,c->s);
+    else snprintf(c->err,c->errsz,"%s at end",msg);
+    c->failed=1;
+}
+static void cc_ws(Cc *c){ while(*c->s==' '||*c->s=='\t') c->s++; }
+static int  cc_accept(Cc *c, char ch){ cc_ws(c); if(*c->s==ch){ c->s++; return 1; } return 0; }
+
+static void cc_emit(Cc *c, int op, int arg, int push){
+    if(c->p->nops>=CX_MAX_OPS){ cc_fail(c,"expression too long"); return; }
+    c->p->op[c->p->nops]=(unsigned char)op;
+    c->p->arg[c->p->nops]=(signed char)arg;
+    c->p->nops++;
+    c->depth += push;
+    if(c->depth>c->max_depth) c->max_depth=c->depth;
+    if(c->depth>CX_STACK) cc_fail(c,"expression nests too deep");
+}
+static Frag cc_const(Cc *c, double re, double im){
+    Frag f={ c->p->nops, 1 };
+    int k=c->p->nconst;
+    if(k>=CX_MAX_CONST){ cc_fail(c,"too many constants"); return f; }
+    c->p->kre[k]=re; c->p->kim[k]=im; c->p->nconst++;
+    cc_emit(c,OP_K,k,+1);
+    return f;
+}
+static void cc_kval(Cc *c, Frag f, double *re, double *im){
+    int k=c->p->arg[f.start];
+    *re=c->p->kre[k]; *im=c->p->kim[k];
+}
+// drop code from f on; constants are numbered in code order, so the ones it
+// used are the tail of the table
+static void cc_rewind(Cc *c, Frag f, int pops){
+    for(int q=f.start;q<c->p->nops;q++)
+        if(c->p->op[q]==OP_K && c->p->arg[q]<c->p->nconst) c->p->nconst=c->p->arg[q];
+    c->p->nops=f.start;
+    c->depth-=pops;
+}
+
+static Frag cc_unop(Cc *c, Frag a, int op){
+    if(a.konst){
+        double ar,ai,r,i; cc_kval(c,a,&ar,&ai);
+        cc_rewind(c,a,1);
+        c_fn(op,ar,ai,0,0,&r,&i);
+        return cc_const(c,r,i);
+    }
+    cc_emit(c,op,0,0);
+    return a;
+}
+static Frag cc_binop(Cc *c, Frag a, Frag b, int op){
+    if(a.konst && b.konst){
+        double ar,ai,br,bi,r,i; cc_kval(c,a,&ar,&ai); cc_kval(c,b,&br,&bi);
+        cc_rewind(c,a,2);
+        c_fn(op,ar,ai,br,bi,&r,&i);
+        return cc_const(c,r,i);
+    }
+    cc_emit(c,op,0,-1);
+    a.konst=0;
+    return a;
+}
+
+static int cc_word(Cc *c, const char *w){
+    cc_ws(c);
+    size_t n=strlen(w);
+    if(strncmp(c->s,w,n)) return 0;
+    char ch=c->s[n];
+    if((ch>='a'&&ch<='z')||(ch>='A'&&ch<='Z')||(ch>='0'&&ch<='9')||ch=='_') return 0;
+    c->s+=n; return 1;
+}
+
+static Frag cc_expr(Cc *c);
+
+static const struct { const char *name; int op; int args; } CC_FUNCS[] = {
+    { "sin",OP_SIN,1 }, { "cos",OP_COS,1 }, { "tan",OP_TAN,1 }, { "exp",OP_EXP,1 },
+    { "log",OP_LOG,1 }, { "sqrt",OP_SQRT,1 }, { "abs",OP_ABS,1 }, { "arg",OP_ARG,1 },
+    { "conj",OP_CONJ,1 }, { "re",OP_RE,1 }, { "im",OP_IM,1 }, { "pow",OP_POW,2 },
+};
+
+static Frag cc_primary(Cc *c){
+    cc_ws(c);
+    if(cc_accept(c,'(')){
+        Frag e=cc_expr(c);
+        if(!cc_accept(c,')')) cc_fail(c,"missing ')'");
+        return e;
+    }
+    for(size_t k=0;k<sizeof(CC_FUNCS)/sizeof(CC_FUNCS[0]);k++){
+        const char *save=c->s;
+        if(!cc_word(c,CC_FUNCS[k].name)) continue;
+        if(!cc_accept(c,'(')){ c->s=save; continue; }
+        Frag a=cc_expr(c);
+        if(CC_FUNCS[k].args==2){
+            if(!cc_accept(c,',')) cc_fail(c,"expected ','");
+            Frag b=cc_expr(c);
+            a=cc_binop(c,a,b,CC_FUNCS[k].op);
+        }else a=cc_unop(c,a,CC_FUNCS[k].op);
+        if(!cc_accept(c,')')) cc_fail(c,"missing ')'");
+        return a;
+    }
+    Frag f={ c->p->nops, 0 };
+    if(cc_word(c,"z")){ cc_emit(c,OP_Z,0,+1); return f; }
+    if(cc_word(c,"c")){ cc_emit(c,OP_C,0,+1); return f; }
+    if(cc_word(c,"p")){ cc_emit(c,OP_P,0,+1); return f; }
+    if(cc_word(c,"t")){ cc_emit(c,OP_T,0,+1); c->p->uses_t=1; return f; }
+    if(cc_word(c,"i")) return cc_const(c,0,1);
+    if(cc_word(c,"pi")) return cc_const(c,M_PI,0);
+    if(cc_word(c,"e")) return cc_const(c,M_E,0);
+    char *end; double val=strtod(c->s,&end);
+    if(end==c->s){ cc_fail(c,"unexpected input"); return cc_const(c,0,0); }
+    c->s=end;
+    if(*c->s=='i'){ c->s++; return cc_const(c,0,val); }
+    return cc_const(c,val,0);
+}
+static Frag cc_unary(Cc *c){
+    if(cc_accept(c,'+')) return cc_unary(c);
+    if(cc_accept(c,'-')) return cc_unop(c,cc_unary(c),OP_NEG);
+    return cc_primary(c);
+}
+static Frag cc_power(Cc *c){
+    Frag a=cc_unary(c);
+    while(cc_accept(c,'^')){
+        Frag b=cc_unary(c);
+        double br,bi;
+        if(b.konst){ cc_kval(c,b,&br,&bi); }
+        // small integer exponents become repeated squaring
+        if(b.konst && bi==0 && br==floor(br) && fabs(br)<=64 && !a.konst){
+            cc_rewind(c,b,1);
+            cc_emit(c,OP_POWI,(int)br,0);
+        }else a=cc_binop(c,a,b,OP_POW);
+    }
+    return a;
+}
+static Frag cc_term(Cc *c){
+    Frag a=cc_power(c);
+    for(;;){
+        if(cc_accept(c,'*')) a=cc_binop(c,a,cc_power(c),OP_MUL);
+        else if(cc_accept(c,'/')) a=cc_binop(c,a,cc_power(c),OP_DIV);
+        else return a;
+    }
+}
+static Frag cc_expr(Cc *c){
+    Frag a=cc_term(c);
+    for(;;){
+        if(cc_accept(c,'+')) a=cc_binop(c,a,cc_term(c),OP_ADD);
+        else if(cc_accept(c,'-')) a=cc_binop(c,a,cc_term(c),OP_SUB);
+        else return a;
+    }
+}
+
+int cx_compile(CxProg *p, const char *src, char *err, size_t errsz){
+    memset(p,0,sizeof(*p));
+    Cc c={ src, p, 0, 0, err, errsz, 0 };
+    if(errsz) err[0]=0;
+    cc_expr(&c);
+    cc_ws(&c);
+    if(*c.s && !c.failed) cc_fail(&c,"trailing input");
+    if(!c.failed && p->nops==0) cc_fail(&c,"empty expression");
+    return c.failed ? -1 : 0;
+}
+
+// ---- vm: one op at a time across the whole batch ----------------------------
+void cx_eval(const CxProg *prog, int n, const double *zr, const double *zi, const double *cr, const double *ci,
+             const double *pr, const double *pi, double t, double *outr, double *outi){
+    double sr[CX_STACK][CX_BATCH], si[CX_STACK][CX_BATCH];
+    int sp=-1;
+    for(int q=0;q<prog->nops;q++){
+        const int op=prog->op[q];
+        double *ar=sr[sp<0?0:sp], *ai=si[sp<0?0:sp];
+        switch(op){
+        case OP_K: {
+            double kr=prog->kre[(int)prog->arg[q]], ki=prog->kim[(int)prog->arg[q]];
+            sp++; for(int k=0;k<n;k++){ sr[sp][k]=kr; si[sp][k]=ki; }
+            break;
+        }
+        case OP_Z: sp++; memcpy(sr[sp],zr,n*sizeof(double)); memcpy(si[sp],zi,n*sizeof(double)); break;
+        case OP_C: sp++; memcpy(sr[sp],cr,n*sizeof(double)); memcpy(si[sp],ci,n*sizeof(double)); break;
+        case OP_P: sp++; memcpy(sr[sp],pr,n*sizeof(double)); memcpy(si[sp],pi,n*sizeof(double)); break;
+        case OP_T: sp++; for(int k=0;k<n;k++){ sr[sp][k]=t; si[sp][k]=0; } break;
+        case OP_ADD: case OP_SUB: case OP_MUL: {
+            double *br=sr[sp], *bi=si[sp]; sp--;
+            ar=sr[sp]; ai=si[sp];
+            if(op==OP_ADD) for(int k=0;k<n;k++){ ar[k]+=br[k]; ai[k]+=bi[k]; }
+            else if(op==OP_SUB) for(int k=0;k<n;k++){ ar[k]-=br[k]; ai[k]-=bi[k]; }
+            else for(int k=0;k<n;k++){ double r=ar[k]*br[k] - ai[k]*bi[k]; ai[k]=ar[k]*bi[k] + ai[k]*br[k]; ar[k]=r; }
+            break;
+        }
+        case OP_DIV: case OP_POW: {
+            double *br=sr[sp], *bi=si[sp]; sp--;
+            ar=sr[sp]; ai=si[sp];
+            for(int k=0;k<n;k++) c_fn(op,ar[k],ai[k],br[k],bi[k],&ar[k],&ai[k]);
+            break;
+        }
+        case OP_NEG: for(int k=0;k<n;k++){ ar[k]=-ar[k]; ai[k]=-ai[k]; } break;
+        case OP_POWI: {
+            const int e=prog->arg[q];
+            if(e==2) for(int k=0;k<n;k++){ double r=ar[k]*ar[k] - ai[k]*ai[k]; ai[k]=2*ar[k]*ai[k]; ar[k]=r; }
+            else for(int k=0;k<n;k++) c_powi(ar[k],ai[k],e,&ar[k],&ai[k]);
+            break;
+        }
+        default: for(int k=0;k<n;k++) c_fn(op,ar[k],ai[k],0,0,&ar[k],&ai[k]); break;
+        }
+    }
+    if(sp<0){ for(int k=0;k<n;k++){ outr[k]=0; outi[k]=0; } return; }
+    memcpy(outr,sr[sp],n*sizeof(double));
+    memcpy(outi,si[sp],n*sizeof(double));
+}
+
+// ---- iteration driver ---------------------------------------------------------
+typedef struct {
+    const FracView *v; const CxMap *m; double t;
+    int *iters; double *zr, *zi; unsigned char *state;
+} CxJob;
+
+static void cx_row(void *ctx, int j){
+    const CxJob *J=(const CxJob*)ctx;
+    const FracView *v=J->v;
+    const double bail2=J->m->bailout*J->m->bailout, conv2=J->m->converge*J->m->converge;
+    double zr[CX_BATCH], zi[CX_BATCH], cr[CX_BATCH], ci[CX_BATCH], pr[CX_BATCH], pi[CX_BATCH];
+    double nr[CX_BATCH], ni[CX_BATCH];
+    int cell[CX_BATCH];
+    for(int i0=0;i0<v->w;i0+=CX_BATCH){
+        int n = v->w-i0<CX_BATCH ? v->w-i0 : CX_BATCH;
+        for(int k=0;k<n;k++){
+            frac_pixel(v,i0+k,j,&pr[k],&pi[k]);
+            if(v->julia){ cr[k]=v->j_re; ci[k]=v->j_im; } else { cr[k]=pr[k]; ci[k]=pi[k]; }
+            cell[k]=j*v->w+i0+k;
+        }
+        cx_eval(&J->m->z0,n,pr,pi,cr,ci,pr,pi,J->t,zr,zi);
+        for(int k=0;k<n;k++){ J->iters[cell[k]]=v->max_iter; J->state[cell[k]]=CX_MAXED; }
+        // live lanes stay packed at the front; finished ones are written out
+        for(int it=0; it<v->max_iter && n>0; it++){
+            cx_eval(&J->m->map,n,zr,zi,cr,ci,pr,pi,J->t,nr,ni);
+            int live=0;
+            for(int k=0;k<n;k++){
+                double dr=nr[k]-zr[k], di=ni[k]-zi[k], m2=nr[k]*nr[k]+ni[k]*ni[k];
+                int st = (!(m2<=bail2)) ? CX_ESCAPED : (dr*dr+di*di<conv2) ? CX_CONVERGED : -1;
+                if(st>=0){
+                    J->iters[cell[k]]=it+1; J->state[cell[k]]=(unsigned char)st;
+                    J->zr[cell[k]]=nr[k]; J->zi[cell[k]]=ni[k];
+                    continue;
+                }
+                zr[live]=nr[k]; zi[live]=ni[k]; cr[live]=cr[k]; ci[live]=ci[k];
+                pr[live]=pr[k]; pi[live]=pi[k]; cell[live]=cell[k];
+                live++;
+            }
+            n=live;
+        }
+        for(int k=0;k<n;k++){ J->zr[cell[k]]=zr[k]; J->zi[cell[k]]=zi[k]; }
+    }
+}
+
+void cx_render(const FracView *v, const CxMap *m, double t, Pool *pool,
+               int *iters, double *zr, double *zi, unsigned char *state){
+    CxJob J={ v, m, t, iters, zr, zi, state };
+    pool_for(pool,v->h,cx_row,&J);
+}
+
+#define CX_MAX_ROOTS 32
+
+int cx_basins(const FracView *v, const double *zr, const double *zi, const unsigned char *state,
+              double tol, int *basin){
+    double rr[CX_MAX_ROOTS], ri[CX_MAX_ROOTS];
+    int nroots=0;
+    const size_t n=(size_t)v->w*v->h;
+    const double tol2=tol*tol;
+    for(size_t k=0;k<n;k++){
+        basin[k]=-1;
+        if(state[k]!=CX_CONVERGED) continue;
+        int r=0;
+        while(r<nroots && (zr[k]-rr[r])*(zr[k]-rr[r]) + (zi[k]-ri[r])*(zi[k]-ri[r]) > tol2) r++;
+        if(r==nroots){
+            if(nroots==CX_MAX_ROOTS) continue;
+            rr[r]=zr[k]; ri[r]=zi[k]; nroots++;
+        }
+        basin[k]=r;
+    }
+    // renumber by angle (then modulus), independent of which root showed up first
+    int order[CX_MAX_ROOTS], rank[CX_MAX_ROOTS];
+    for(int r=0;r<nroots;r++) order[r]=r;
+    for(int a=1;a<nroots;a++){
+        int x=order[a], b=a;
+        double ax=atan2(ri[x],rr[x]), mx=hypot(rr[x],ri[x]);
+        while(b>0){
+            int y=order[b-1];
+            double ay=atan2(ri[y],rr[y]), my=hypot(rr[y],ri[y]);
+            if(ay<ax || (ay==ax && my<=mx)) break;
+            order[b]=y; b--;
+        }
+        order[b]=x;
+    }
+    for(int r=0;r<nroots;r++) rank[order[r]]=r;
+    for(size_t k=0;k<n;k++) if(basin[k]>=0) basin[k]=rank[basin[k]];
+    return nroots;
+}
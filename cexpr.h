@@ -0,0 +1,45 @@
+#ifndef CEXPR_H
+#define CEXPR_H
+#include <stddef.h>
+#include "fractal.h"
+
+/* complex expressions compiled once to a stack bytecode, then run over
+   batches of cells so dispatch cost is paid per batch, not per cell.
+   variables: z (current value), c (pixel, or julia c), p (pixel), t (time),
+   i (imaginary unit), pi, e; 2.5i is an imaginary literal */
+#define CX_MAX_OPS   256
+#define CX_MAX_CONST 64
+#define CX_STACK     16
+#define CX_BATCH     64
+
+typedef struct {
+    unsigned char op[CX_MAX_OPS];
+    signed char   arg[CX_MAX_OPS];    // constant index / integer power
+    double        kre[CX_MAX_CONST], kim[CX_MAX_CONST];
+    int           nops, nconst;
+    int           uses_t;
+} CxProg;
+
+/* 0 on success; -1 with a message in err */
+int  cx_compile(CxProg *p, const char *src, char *err, size_t errsz);
+/* out[k] = f(z[k], c[k], p[k], t) for k < n (n <= CX_BATCH) */
+void cx_eval(const CxProg *prog, int n, const double *zr, const double *zi, const double *cr, const double *ci,
+             const double *pr, const double *pi, double t, double *outr, double *outi);
+
+/* z -> map(z) until |z| passes bailout (escaped) or a step moves less than
+   converge (converged), at most max_iter times; z0 is its own expression */
+typedef struct {
+    CxProg map, z0;
+    double bailout, converge;
+} CxMap;
+
+enum { CX_MAXED=0, CX_ESCAPED=1, CX_CONVERGED=2 };
+
+/* per cell: iterations, final z and how the orbit ended. rows are spread over pool */
+void cx_render(const FracView *v, const CxMap *m, double t, Pool *pool,
+               int *iters, double *zr, double *zi, unsigned char *state);
+/* number converged cells by the root they reached (-1 otherwise); roots are
+   ordered by angle so colors stay put while panning. returns the root count */
+int  cx_basins(const FracView *v, const double *zr, const double *zi, const unsigned char *state,
+               double tol, int *basin);
+#endif
@@ -0,0 +1,228 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+#include "dither.h"
+#include "vec.h"
+#include <math.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BAYER_TILE 8
+#define BLUE_TILE  64     // blue-noise tile, built by void-and-cluster on first use
+#define FS_PUBLISH 32     // fs: a row reports its progress every this many cells
+
+static float g_bayer[BAYER_TILE*BAYER_TILE];
+static float g_blue[BLUE_TILE*BLUE_TILE];
+static float g_half[BAYER_TILE*BAYER_TILE];   // plain rounding, for the vector path
+static int   g_tables;
+
+/* rank of (x,y) in the recursive bayer matrix: bits of x^y and y interleaved, reversed */
+static void bayer_init(void){
+    for(int y=0;y<BAYER_TILE;y++)
+        for(int x=0;x<BAYER_TILE;x++){
+            int r=0;
+            for(int b=0;b<3;b++)
+                r |= (((x^y)>>b)&1) << (5-2*b) | ((y>>b)&1) << (4-2*b);
+            g_bayer[y*BAYER_TILE+x]=(r+0.5f)/(BAYER_TILE*BAYER_TILE);
+            g_half[y*BAYER_TILE+x]=0.5f;
+        }
+}
+
+/* void-and-cluster (Ulichney): the energy of a cell is a toroidal gaussian
+   sum over the set cells. settle a sparse random pattern by moving its
+   tightest cluster into its largest void, then rank it: remove clusters
+   downwards from its size, fill voids upwards to the full tile */
+#define VC_N (BLUE_TILE*BLUE_TILE)
+static float vc_g[VC_N];
+
+static void vc_put(float *E, unsigned char *P, int c, int on){
+    const int cx=c%BLUE_TILE, cy=c/BLUE_TILE;
+    const float s = on ? 1.f : -1.f;
+    P[c]=(unsigned char)on;
+    for(int y=0;y<BLUE_TILE;y++){
+        const float *g=vc_g + ((y-cy)&(BLUE_TILE-1))*BLUE_TILE;
+        float *e=E + y*BLUE_TILE;
+        for(int x=0;x<BLUE_TILE;x++) e[x] += s*g[(x-cx)&(BLUE_TILE-1)];
+    }
+}
+static int vc_cluster(const float *E, const unsigned char *P){
+    int b=-1;
+    for(int k=0;k<VC_N;k++) if(P[k] && (b<0 || E[k]>E[b])) b=k;
+    return b;
+}
+static int vc_void(const float *E, const unsigned char *P){
+    int b=-1;
+    for(int k=0;k<VC_N;k++) if(!P[k] && (b<0 || E[k]<E[b])) b=k;
+    return b;
+}
+
+static void blue_init(void){
+    static float E[VC_N], E0[VC_N];
+    static unsigned char P[VC_N], P0[VC_N];
+    static int rank[VC_N];
+    for(int y=0;y<BLUE_TILE;y++)
+        for(int x=0;x<BLUE_TILE;x++){
+            const int dx = x<BLUE_TILE/2 ? x : BLUE_TILE-x, dy = y<BLUE_TILE/2 ? y : BLUE_TILE-y;
+            vc_g[y*BLUE_TILE+x] = expf(-(float)(dx*dx + dy*dy)/(2*1.5f*1.5f));
+        }
+    memset(E,0,sizeof(E)); memset(P,0,sizeof(P));
+    unsigned s=1;
+    int ones=0;
+    while(ones<VC_N/10){
+        s = s*1103515245u + 12345u;
+        const int c=(int)((s>>8)%VC_N);
+        if(!P[c]){ vc_put(E,P,c,1); ones++; }
+    }
+    for(;;){
+        const int c=vc_cluster(E,P);
+        vc_put(E,P,c,0);
+        const int v=vc_void(E,P);
+        vc_put(E,P,v,1);
+        if(v==c) break;
+    }
+    memcpy(E0,E,sizeof(E)); memcpy(P0,P,sizeof(P));
+    for(int r=ones-1;r>=0;r--){ const int c=vc_cluster(E,P); vc_put(E,P,c,0); rank[c]=r; }
+    memcpy(E,E0,sizeof(E)); memcpy(P,P0,sizeof(P));
+    for(int r=ones;r<VC_N;r++){ const int v=vc_void(E,P); vc_put(E,P,v,1); rank[v]=r; }
+    for(int k=0;k<VC_N;k++) g_blue[k]=(rank[k]+0.5f)/VC_N;
+}
+
+#if defined(__GNUC__)
+#define DITHER_LANES (FRAC_VEC_BYTES/4)
+static inline vf32 vld(const float *p){ vf32 v; memcpy(&v,p,sizeof(v)); return v; }
+#endif
+
+typedef struct {
+    const float *val; unsigned char *idx;
+    int w, h, levels;
+    const float *thr; int tile;   // ordered
+    DitherBuf *b;                 // diffusion
+} DitherJob;
+
+/* floor(level + threshold) with the threshold tile repeated along the row */
+static void ordered_row(void *ctx, int j){
+    const DitherJob *J=(const DitherJob*)ctx;
+    const float *v=J->val + (size_t)j*J->w;
+    unsigned char *o=J->idx + (size_t)j*J->w;
+    const float *thr=J->thr + (j & (J->tile-1))*J->tile;
+    const float s=0.5f*(J->levels-1);
+    const int top=J->levels-1, m=J->tile-1;
+    int i=0;
+#ifdef DITHER_LANES
+    for(;i+DITHER_LANES<=J->w;i+=DITHER_LANES){
+        vi32 q=__builtin_convertvector(vld(v+i)*s + s + vld(thr + (i&m)), vi32);
+        q &= q>=0;                         // below the ramp
+        const vi32 over = q>top;
+        q = (q & ~over) | (over & top);
+        for(int k=0;k<DITHER_LANES;k++) o[i+k]=(unsigned char)q[k];
+    }
+#endif
+    for(;i<J->w;i++){
+        const float t=v[i]*s + s + thr[i&m];
+        o[i] = (unsigned char)(t>=top ? top : t>0 ? (int)t : 0);
+    }
+}
+
+static inline int fs_quant(float *x, int top){
+    if(!(*x>-0.5f)) *x=-0.5f;              // bound the error a saturated run can build up
+    if(*x>top+0.5f) *x=top+0.5f;
+    int q=(int)floorf(*x+0.5f);
+    return q<0 ? 0 : q>top ? top : q;
+}
+
+/* fs: row j may take cell i once row j-1 is done with i+1, the last cell
+   to push error into it */
+static void fs_row(void *ctx, int j){
+    const DitherJob *J=(const DitherJob*)ctx;
+    const int w=J->w, top=J->levels-1;
+    const float s=0.5f*top;
+    const float *v=J->val + (size_t)j*w;
+    unsigned char *o=J->idx + (size_t)j*w;
+    float *er=J->b->err + (size_t)j*w, *en = j+1<J->h ? er+w : NULL;
+    int *above = j ? &J->b->done[j-1] : NULL;
+    int ready = above ? 0 : w;
+    float carry=0;
+    for(int i=0;i<w;i++){
+        const int need = i+2<w ? i+2 : w;
+        while(ready<need){
+            ready=__atomic_load_n(above,__ATOMIC_ACQUIRE);
+            if(ready<need) sched_yield();
+        }
+        float x = v[i]*s + s + er[i] + carry;
+        const int q=fs_quant(&x,top);
+        const float e=x-q;
+        o[i]=(unsigned char)q;
+        carry = e*(7.f/16);
+        if(en){
+            if(i>0) en[i-1] += e*(3.f/16);
+            en[i] += e*(5.f/16);
+            if(i+1<w) en[i+1] += e*(1.f/16);
+        }
+        if((i+1)%FS_PUBLISH==0 || i+1==w) __atomic_store_n(&J->b->done[j],i+1,__ATOMIC_RELEASE);
+    }
+}
+
+static void serpentine(const DitherJob *J){
+    const int w=J->w, top=J->levels-1;
+    const float s=0.5f*top;
+    for(int j=0;j<J->h;j++){
+        const float *v=J->val + (size_t)j*w;
+        unsigned char *o=J->idx + (size_t)j*w;
+        float *er=J->b->err + (size_t)j*w, *en = j+1<J->h ? er+w : NULL;
+        const int d = j&1 ? -1 : 1;
+        float carry=0;
+        for(int n=0,i = d>0 ? 0 : w-1; n<w; n++,i+=d){
+            float x = v[i]*s + s + er[i] + carry;
+            const int q=fs_quant(&x,top);
+            const float e=x-q;
+            o[i]=(unsigned char)q;
+            carry = e*(7.f/16);
+            if(en){
+                if(i-d>=0 && i-d<w) en[i-d] += e*(3.f/16);
+                en[i] += e*(5.f/16);
+                if(i+d>=0 && i+d<w) en[i+d] += e*(1.f/16);
+            }
+        }
+    }
+}
+
+int dither_quantize(DitherKind k, const float *val, int w, int h, int levels,
+                    unsigned char *idx, DitherBuf *b, Pool *pool){
+    const size_t n=(size_t)w*h;
+    if(w<=0 || h<=0) return 0;
+    if(levels<=1){ memset(idx,0,n); return 0; }
+    if(levels>256) levels=256;
+    if(k==DITHER_OFF){   // same rounding as a plain ramp lookup
+        for(size_t c=0;c<n;c++){
+            double t=(val[c]+1.0)*0.5; if(!(t>0)) t=0; if(t>1) t=1;
+            idx[c]=(unsigned char)floor(t*(levels-1)+0.5);
+        }
+        return 0;
+    }
+    DitherJob J={ val, idx, w, h, levels, NULL, 0, b };
+    if(k==DITHER_BAYER || k==DITHER_BLUE){
+        if(!g_tables){ bayer_init(); blue_init(); g_tables=1; }
+        J.thr = k==DITHER_BAYER ? g_bayer : g_blue;
+        J.tile = k==DITHER_BAYER ? BAYER_TILE : BLUE_TILE;
+        pool_for(pool,h,ordered_row,&J);
+        return 0;
+    }
+    if(n>b->cap){
+        float *e=(float*)realloc(b->err,n*sizeof(float)); if(!e) return -1;
+        b->err=e; b->cap=n;
+    }
+    if((size_t)h>b->rows){
+        int *d=(int*)realloc(b->done,(size_t)h*sizeof(int)); if(!d) return -1;
+        b->done=d; b->rows=(size_t)h;
+    }
+    memset(b->err,0,n*sizeof(float));
+    if(k==DITHER_SERPENTINE){ serpentine(&J); return 0; }
+    memset(b->done,0,(size_t)h*sizeof(int));
+    pool_for(pool,h,fs_row,&J);
+    return 0;
+}
+
+void dither_free(DitherBuf *b){
+    free(b->err); free(b->done);
+    memset(b,0,sizeof(*b));
+}
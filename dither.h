@@ -0,0 +1,25 @@
+#ifndef DITHER_H
+#define DITHER_H
+#include <stddef.h>
+#include "pool.h"
+
+/* quantization of a value grid to a few levels (glyphs, palette steps).
+   ordered kinds add a per-position threshold and run rows in parallel;
+   error diffusion carries each cell's rounding error to its unvisited
+   neighbours. fs runs every row left to right, so a row can start as soon
+   as the row above is a few cells ahead of it; serpentine alternates
+   direction, which needs the whole row above and so runs serially */
+typedef enum { DITHER_OFF=0, DITHER_BAYER, DITHER_BLUE, DITHER_FS, DITHER_SERPENTINE } DitherKind;
+
+typedef struct {
+    float  *err;     // error diffused into each cell
+    int    *done;    // fs: cells finished per row
+    size_t  cap, rows;
+} DitherBuf;
+
+/* idx[w*h] = level 0..levels-1 (levels<=256) of val[w*h] in -1..1. OFF
+   rounds to the nearest level. -1 on allocation failure */
+int  dither_quantize(DitherKind k, const float *val, int w, int h, int levels,
+                     unsigned char *idx, DitherBuf *b, Pool *pool);
+void dither_free(DitherBuf *b);
+#endif
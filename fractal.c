@@ -0,0 +1,850 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+#include "fractal.h"
+#include "vec.h"
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FRAC_TODO  (-1)
+#define SD_MIN_SPAN 4    // rects thinner than this are iterated cell by cell
+
+int frac_inside(const FracView *v){
+    return v->smooth ? v->max_iter*FRAC_SMOOTH : v->max_iter;
+}
+
+/* escape count of an orbit that ended at z after iter steps. smooth counts
+   subtract log_d(log|z|/log 2), which runs 0..1 across one escape band */
+static int escape_value(const FracView *v, int iter, double zr, double zi){
+    if(!v->smooth) return iter;
+    if(iter>=v->max_iter) return v->max_iter*FRAC_SMOOTH;
+    const double m2=zr*zr + zi*zi;
+    double f=0;
+    if(m2>4.0){
+        const double d = v->formula==FRAC_ZPOW ? v->power : 2;
+        f = log(0.5*log(m2)/M_LN2)/log(d);
+        if(!(f>=0)) f=0; else if(f>1) f=1;
+    }
+    int s=(int)lrint((iter - f)*FRAC_SMOOTH);
+    return s<0 ? 0 : s;
+}
+
+// offset of cell (i,j) from the view center
+static void frac_offset(const FracView *v, int i, int j, double *dx, double *dy){
+    const double ar = (double)v->h/(double)(v->w>0?v->w:1);
+    *dx = ( ((double)i + v->sub_i)/(v->w>1?v->w-1:1) - 0.5 ) * v->scale;
+    *dy = ( ((double)j + v->sub_j)/(v->h>1?v->h-1:1) - 0.5 ) * v->scale * ar;
+}
+
+void frac_pixel(const FracView *v, int i, int j, double *x, double *y){
+    double dx,dy; frac_offset(v,i,j,&dx,&dy);
+    *x = v->cx + dx;
+    *y = v->cy + dy;
+}
+
+/* perturbation: iterate the delta dz against the reference orbit Z,
+   dz' = (2Z + dz)dz + dc. When |Z+dz| drops below |dz| the delta has lost
+   its precision relative to the full value (a glitch); rebase onto Z_0 */
+static int perturb_init(const FracView *v, int i, int j, double *dzr, double *dzi, int *m){
+    const FracRef *R = v->ref;
+    double dcr,dci; frac_offset(v,i,j,&dcr,&dci);
+    if(R->skip>0){   // dz = A*d + B*d^2 + C*d^3
+        double d2r = dcr*dcr - dci*dci, d2i = 2*dcr*dci;
+        double d3r = d2r*dcr - d2i*dci, d3i = d2r*dci + d2i*dcr;
+        *dzr = R->a_re*dcr - R->a_im*dci + R->b_re*d2r - R->b_im*d2i + R->c_re*d3r - R->c_im*d3i;
+        *dzi = R->a_re*dci + R->a_im*dcr + R->b_re*d2i + R->b_im*d2r + R->c_re*d3i + R->c_im*d3r;
+        *m = R->skip;
+        return 0;
+    }
+    *m = 0;
+    if(v->julia){
+        *dzr=dcr; *dzi=dci;
+        double zr=R->zr[0]+dcr, zi=R->zi[0]+dci;
+        return zr*zr+zi*zi>4.0;
+    }
+    *dzr=0; *dzi=0;
+    return 0;
+}
+
+// advance until iteration limit; returns 1 once the orbit escaped
+static int perturb_run(const FracView *v, int i, int j, double *pdzr, double *pdzi, int *pm, int *piter, int limit){
+    const FracRef *R = v->ref;
+    double dcr=0,dci=0;
+    if(!v->julia) frac_offset(v,i,j,&dcr,&dci);
+    double dzr=*pdzr, dzi=*pdzi;
+    int m=*pm, iter=*piter, out=0;
+    while(iter<limit){
+        double tr = 2*R->zr[m] + dzr, ti = 2*R->zi[m] + dzi;
+        double nr = tr*dzr - ti*dzi + dcr;
+        dzi = tr*dzi + ti*dzr + dci;
+        dzr = nr;
+        m++; iter++;
+        double zr = R->zr[m] + dzr, zi = R->zi[m] + dzi;
+        double mag = zr*zr + zi*zi;
+        if(mag>4.0){ out=1; break; }
+        if(mag < dzr*dzr+dzi*dzi || m>=R->len){
+            dzr = zr - R->zr[0]; dzi = zi - R->zi[0];
+            m = 0;
+        }
+    }
+    *pdzr=dzr; *pdzi=dzi; *pm=m; *piter=iter;
+    return out;
+}
+
+static int escape_perturb(const FracView *v, int i, int j){
+    double dzr,dzi; int m, iter;
+    if(perturb_init(v,i,j,&dzr,&dzi,&m)) return 0;
+    iter = m;
+    if(!perturb_run(v,i,j,&dzr,&dzi,&m,&iter,v->max_iter)) return frac_inside(v);
+    return escape_value(v,iter,v->ref->zr[m]+dzr,v->ref->zi[m]+dzi);
+}
+
+// ---- double-double arithmetic (Dekker/Knuth): ~106-bit mantissa ----------
+typedef struct { double hi, lo; } DD;
+
+static inline DD two_sum(double a, double b){
+    double s=a+b, bb=s-a;
+    DD r={ s, (a-(s-bb)) + (b-bb) };
+    return r;
+}
+static inline DD quick_two_sum(double a, double b){
+    double s=a+b;
+    DD r={ s, b-(s-a) };
+    return r;
+}
+static inline DD two_prod(double a, double b){
+    const double split=134217729.0;   // 2^27+1
+    double p=a*b;
+    double ta=split*a, ah=ta-(ta-a), al=a-ah;
+    double tb=split*b, bh=tb-(tb-b), bl=b-bh;
+    DD r={ p, ((ah*bh-p) + ah*bl + al*bh) + al*bl };
+    return r;
+}
+static inline DD dd_add(DD a, DD b){
+    DD s=two_sum(a.hi,b.hi), t=two_sum(a.lo,b.lo);
+    s.lo+=t.hi; s=quick_two_sum(s.hi,s.lo);
+    s.lo+=t.lo; return quick_two_sum(s.hi,s.lo);
+}
+static inline DD dd_sub(DD a, DD b){ DD nb={ -b.hi, -b.lo }; return dd_add(a,nb); }
+static inline DD dd_mul(DD a, DD b){
+    DD p=two_prod(a.hi,b.hi);
+    p.lo += a.hi*b.lo + a.lo*b.hi;
+    return quick_two_sum(p.hi,p.lo);
+}
+
+static void dd_pixel(const FracView *v, int i, int j, DD *px, DD *py){
+    double dx,dy; frac_offset(v,i,j,&dx,&dy);
+    *px=dd_add((DD){ v->cx, v->cx_lo },(DD){ dx, 0 });
+    *py=dd_add((DD){ v->cy, v->cy_lo },(DD){ dy, 0 });
+}
+
+// z0 of cell (i,j); dd_run rederives c and returns 1 once the orbit escaped
+static void dd_init(const FracView *v, int i, int j, DD *x, DD *y){
+    if(v->julia) dd_pixel(v,i,j,x,y);
+    else { x->hi=x->lo=y->hi=y->lo=0; }
+}
+/* one iteration z -> f(z) + c for each formula. Every variant is its own
+   kernel instance, so the inner loops carry no formula branches; ABS is the
+   type's absolute value (only the burning ship folds) */
+#define STEP_Z2(T,ABS,x,y,xx,yy,cr,ci,xn,yn)   xn = xx - yy + cr; yn = (x+x)*y + ci;
+#define STEP_SHIP(T,ABS,x,y,xx,yy,cr,ci,xn,yn) xn = xx - yy + cr; yn = ABS((x+x)*y) + ci;
+#define STEP_TRI(T,ABS,x,y,xx,yy,cr,ci,xn,yn)  xn = xx - yy + cr; yn = ci - (x+x)*y;
+#define STEP_POW(P,T,ABS,x,y,xx,yy,cr,ci,xn,yn) { \
+    T pr_=x, pi_=y; \
+    for(int q_=1;q_<P;q_++){ T t_ = pr_*x - pi_*y; pi_ = pr_*y + pi_*x; pr_ = t_; } \
+    xn = pr_ + cr; yn = pi_ + ci; }
+#define STEP_P3(...) STEP_POW(3,__VA_ARGS__)
+#define STEP_P4(...) STEP_POW(4,__VA_ARGS__)
+#define STEP_P5(...) STEP_POW(5,__VA_ARGS__)
+#define STEP_P6(...) STEP_POW(6,__VA_ARGS__)
+#define STEP_P7(...) STEP_POW(7,__VA_ARGS__)
+#define STEP_P8(...) STEP_POW(8,__VA_ARGS__)
+
+// kernel table order; see kernel_index()
+#define FORMULAS(X) X(z2,STEP_Z2) X(p3,STEP_P3) X(p4,STEP_P4) X(p5,STEP_P5) \
+                    X(p6,STEP_P6) X(p7,STEP_P7) X(p8,STEP_P8) X(ship,STEP_SHIP) X(tri,STEP_TRI)
+
+static int kernel_index(const FracView *v){
+    switch(v->formula){
+    case FRAC_ZPOW:    return v->power<=2 ? 0 : (v->power>=FRAC_MAX_POWER ? FRAC_MAX_POWER : v->power) - 2;
+    case FRAC_SHIP:    return FRAC_MAX_POWER-1;
+    case FRAC_TRICORN: return FRAC_MAX_POWER;
+    default:           return 0;
+    }
+}
+
+static inline DD dd_abs(DD a){ if(a.hi<0){ a.hi=-a.hi; a.lo=-a.lo; } return a; }
+static inline DD dd_neg(DD a){ a.hi=-a.hi; a.lo=-a.lo; return a; }
+static inline DD dd_twice(DD a){ a.hi*=2; a.lo*=2; return a; }
+
+// the same steps spelled in double-double arithmetic
+#define DD_SQ_PART(x,y,cr) dd_add(dd_sub(dd_mul(x,x),dd_mul(y,y)),cr)
+#define DD_STEP_Z2(x,y,cr,ci)   { DD xy=dd_twice(dd_mul(x,y)); x=DD_SQ_PART(x,y,cr); y=dd_add(xy,ci); }
+#define DD_STEP_SHIP(x,y,cr,ci) { DD xy=dd_abs(dd_twice(dd_mul(x,y))); x=DD_SQ_PART(x,y,cr); y=dd_add(xy,ci); }
+#define DD_STEP_TRI(x,y,cr,ci)  { DD xy=dd_twice(dd_mul(x,y)); x=DD_SQ_PART(x,y,cr); y=dd_sub(ci,xy); }
+#define DD_STEP_POW(P,x,y,cr,ci) { \
+    DD pr_=x, pi_=y; \
+    for(int q_=1;q_<P;q_++){ DD t_=dd_sub(dd_mul(pr_,x),dd_mul(pi_,y)); pi_=dd_add(dd_mul(pr_,y),dd_mul(pi_,x)); pr_=t_; } \
+    x=dd_add(pr_,cr); y=dd_add(pi_,ci); }
+#define DD_STEP_P3(...) DD_STEP_POW(3,__VA_ARGS__)
+#define DD_STEP_P4(...) DD_STEP_POW(4,__VA_ARGS__)
+#define DD_STEP_P5(...) DD_STEP_POW(5,__VA_ARGS__)
+#define DD_STEP_P6(...) DD_STEP_POW(6,__VA_ARGS__)
+#define DD_STEP_P7(...) DD_STEP_POW(7,__VA_ARGS__)
+#define DD_STEP_P8(...) DD_STEP_POW(8,__VA_ARGS__)
+
+typedef int (*DDRun)(const FracView *v, int i, int j, DD *px, DD *py, int *piter, int limit);
+
+#define DEFINE_DD_RUN(NAME, STEP) \
+static int dd_run_##NAME(const FracView *v, int i, int j, DD *px, DD *py, int *piter, int limit){ \
+    DD cr,ci; \
+    if(v->julia){ cr=(DD){ v->j_re, 0 }; ci=(DD){ v->j_im, 0 }; } \
+    else dd_pixel(v,i,j,&cr,&ci); \
+    DD x=*px, y=*py; \
+    int iter=*piter; \
+    while(x.hi*x.hi+y.hi*y.hi<=4.0 && iter<limit){ DD_##STEP(x,y,cr,ci) iter++; } \
+    *px=x; *py=y; *piter=iter; \
+    return x.hi*x.hi+y.hi*y.hi>4.0; \
+}
+#define DD_RUN_ENTRY(NAME, STEP) dd_run_##NAME,
+FORMULAS(DEFINE_DD_RUN)
+static const DDRun DD_RUNS[] = { FORMULAS(DD_RUN_ENTRY) };
+
+static int dd_run(const FracView *v, int i, int j, DD *px, DD *py, int *piter, int limit){
+    return DD_RUNS[kernel_index(v)](v,i,j,px,py,piter,limit);
+}
+
+static int escape_dd(const FracView *v, int i, int j){
+    DD x,y; int iter=0;
+    dd_init(v,i,j,&x,&y);
+    dd_run(v,i,j,&x,&y,&iter,v->max_iter);
+    return escape_value(v,iter,x.hi,y.hi);
+}
+
+// ---- float/double kernels ------------------------------------------------
+/* L orbits step together; finished lanes are masked instead of branched on,
+   and float packs twice as many lanes per 32-byte vector as double.
+   z and cnt are advanced in place by up to budget steps; live[k] is cleared
+   once orbit k escaped or reached max. float state round-trips through
+   double exactly, so a resumed orbit matches an uninterrupted one */
+typedef void (*OrbitLanes)(double *zr, double *zi, const double *cr0, const double *ci0, int *cnt0,
+                           unsigned char *live0, int n, int max, int budget);
+
+/* one orbit at a time, for callers that want single cells (subdivision) */
+typedef int (*EscapeOne)(const FracView *v, double zr, double zi, double cr, double ci);
+
+#define SABS(v) ((v)<0 ? -(v) : (v))
+#define DEFINE_ESCAPE_ONE(NAME, T, STEP) \
+static int NAME(const FracView *v, double zr, double zi, double cr0, double ci0){ \
+    T x=(T)zr, y=(T)zi, cr=(T)cr0, ci=(T)ci0; \
+    int iter=0; const int max=v->max_iter; \
+    for(;;){ \
+        T xx=x*x, yy=y*y, xn, yn; \
+        if(xx+yy>(T)4 || iter>=max) break; \
+        STEP(T,SABS,x,y,xx,yy,cr,ci,xn,yn) \
+        x=xn; y=yn; iter++; \
+    } \
+    return escape_value(v,iter,x,y); \
+}
+#define DEFINE_ONE_F(NAME, STEP) DEFINE_ESCAPE_ONE(escape_f_##NAME, float,  STEP)
+#define DEFINE_ONE_D(NAME, STEP) DEFINE_ESCAPE_ONE(escape_d_##NAME, double, STEP)
+#define ONE_F_ENTRY(NAME, STEP) escape_f_##NAME,
+#define ONE_D_ENTRY(NAME, STEP) escape_d_##NAME,
+FORMULAS(DEFINE_ONE_F)
+FORMULAS(DEFINE_ONE_D)
+static const EscapeOne ESCAPE_F[] = { FORMULAS(ONE_F_ENTRY) };
+static const EscapeOne ESCAPE_D[] = { FORMULAS(ONE_D_ENTRY) };
+
+#if defined(__GNUC__)
+#define DEFINE_ORBIT_LANES(NAME, T, VT, VI, L, ABS, STEP) \
+static void NAME(double *zr, double *zi, const double *cr0, const double *ci0, int *cnt0, \
+                 unsigned char *live0, int n, int max, int budget){ \
+    for(int base=0; base<n; base+=L){ \
+        const int m = n-base<L ? n-base : L; \
+        VT x, y, cr, ci, four; VI cnt, live, vmax; \
+        for(int k=0;k<L;k++){ \
+            int s = base + (k<m ? k : 0); \
+            x[k]=(T)zr[s]; y[k]=(T)zi[s]; cr[k]=(T)cr0[s]; ci[k]=(T)ci0[s]; \
+            four[k]=4; cnt[k]=cnt0[s]; vmax[k]=max; live[k] = (k<m && live0[s]) ? -1 : 0; \
+        } \
+        for(int it=0; it<budget; it++){ \
+            VT xx=x*x, yy=y*y, xn, yn; \
+            VI a = live & (xx+yy <= four) & (cnt < vmax); \
+            STEP(VT,ABS,x,y,xx,yy,cr,ci,xn,yn) \
+            x = (VT)(((VI)xn & a) | ((VI)x & ~a)); \
+            y = (VT)(((VI)yn & a) | ((VI)y & ~a)); \
+            cnt -= a; live = a; \
+            if((it&7)==7){ \
+                int any=0; \
+                for(int k=0;k<L;k++) any |= (live[k]!=0); \
+                if(!any) break; \
+            } \
+        } \
+        live &= (x*x+y*y <= four) & (cnt < vmax); \
+        for(int k=0;k<m;k++){ \
+            zr[base+k]=x[k]; zi[base+k]=y[k]; cnt0[base+k]=(int)cnt[k]; live0[base+k]=live[k]!=0; \
+        } \
+    } \
+}
+
+#define DEFINE_LANES_F(NAME, STEP) DEFINE_ORBIT_LANES(orbit_f_##NAME, float,  vf32, vi32, FRAC_VEC_BYTES/4, VABS_F, STEP)
+#define DEFINE_LANES_D(NAME, STEP) DEFINE_ORBIT_LANES(orbit_d_##NAME, double, vf64, vi64, FRAC_VEC_BYTES/8, VABS_D, STEP)
+#else
+#define DEFINE_ORBIT_LANES(NAME, T, L, STEP) \
+static void NAME(double *zr, double *zi, const double *cr0, const double *ci0, int *cnt0, \
+                 unsigned char *live0, int n, int max, int budget){ \
+    for(int base=0; base<n; base+=L){ \
+        const int m = n-base<L ? n-base : L; \
+        T x[L], y[L], cr[L], ci[L]; int cnt[L], live[L]; \
+        for(int k=0;k<L;k++){ \
+            int s = base + (k<m ? k : 0); \
+            x[k]=(T)zr[s]; y[k]=(T)zi[s]; cr[k]=(T)cr0[s]; ci[k]=(T)ci0[s]; \
+            cnt[k]=cnt0[s]; live[k]=(k<m && live0[s]); \
+        } \
+        for(int it=0; it<budget; it++){ \
+            int any=0; \
+            for(int k=0;k<L;k++){ \
+                T xx=x[k]*x[k], yy=y[k]*y[k], xn, yn; \
+                int a = live[k] & (xx+yy<=(T)4) & (cnt[k]<max); \
+                STEP(T,SABS,x[k],y[k],xx,yy,cr[k],ci[k],xn,yn) \
+                x[k] = a ? xn : x[k]; y[k] = a ? yn : y[k]; \
+                cnt[k] += a; live[k] = a; any |= a; \
+            } \
+            if(!any) break; \
+        } \
+        for(int k=0;k<m;k++){ \
+            zr[base+k]=x[k]; zi[base+k]=y[k]; cnt0[base+k]=cnt[k]; \
+            live0[base+k]=live[k] && x[k]*x[k]+y[k]*y[k]<=(T)4 && cnt[k]<max; \
+        } \
+    } \
+}
+
+#define DEFINE_LANES_F(NAME, STEP) DEFINE_ORBIT_LANES(orbit_f_##NAME, float,  8, STEP)
+#define DEFINE_LANES_D(NAME, STEP) DEFINE_ORBIT_LANES(orbit_d_##NAME, double, 4, STEP)
+#endif
+
+#define LANES_F_ENTRY(NAME, STEP) orbit_f_##NAME,
+#define LANES_D_ENTRY(NAME, STEP) orbit_d_##NAME,
+FORMULAS(DEFINE_LANES_F)
+FORMULAS(DEFINE_LANES_D)
+static const OrbitLanes ORBIT_F[] = { FORMULAS(LANES_F_ENTRY) };
+static const OrbitLanes ORBIT_D[] = { FORMULAS(LANES_D_ENTRY) };
+
+static OrbitLanes orbit_lanes(const FracView *v){
+    return (v->prec==FRAC_PREC_FLOAT ? ORBIT_F : ORBIT_D)[kernel_index(v)];
+}
+
+// z0 and c of cell (i,j) for the float/double kernels
+static void lanes_seed(const FracView *v, int i, int j, double *zr, double *zi, double *cr, double *ci){
+    double px,py; frac_pixel(v,i,j,&px,&py);
+    if(v->julia){ *zr=px; *zi=py; *cr=v->j_re; *ci=v->j_im; }
+    else        { *zr=0;  *zi=0;  *cr=px;      *ci=py;      }
+}
+
+int frac_escape(const FracView *v, int i, int j){
+    if(v->prec==FRAC_PREC_PERTURB && v->ref) return escape_perturb(v,i,j);
+    if(v->prec==FRAC_PREC_DD) return escape_dd(v,i,j);
+    double zr,zi,cr,ci;
+    lanes_seed(v,i,j,&zr,&zi,&cr,&ci);
+    return (v->prec==FRAC_PREC_FLOAT ? ESCAPE_F : ESCAPE_D)[kernel_index(v)](v,zr,zi,cr,ci);
+}
+
+#define SPAN_CHUNK 64
+
+// iterate cells i0, i0+stride, ... (n of them) of row j into row[]
+static void escape_span(const FracView *v, int j, int i0, int stride, int n, int *row){
+    if(v->prec!=FRAC_PREC_FLOAT && v->prec!=FRAC_PREC_DOUBLE){
+        for(int k=0;k<n;k++) row[i0+k*stride] = frac_escape(v,i0+k*stride,j);
+        return;
+    }
+    double zr[SPAN_CHUNK], zi[SPAN_CHUNK], cr[SPAN_CHUNK], ci[SPAN_CHUNK];
+    int out[SPAN_CHUNK]; unsigned char live[SPAN_CHUNK];
+    const OrbitLanes run = orbit_lanes(v);
+    for(int b=0;b<n;b+=SPAN_CHUNK){
+        int m = n-b<SPAN_CHUNK ? n-b : SPAN_CHUNK;
+        for(int k=0;k<m;k++){
+            lanes_seed(v,i0+(b+k)*stride,j,&zr[k],&zi[k],&cr[k],&ci[k]);
+            out[k]=0; live[k]=1;
+        }
+        run(zr,zi,cr,ci,out,live,m,v->max_iter,v->max_iter);
+        for(int k=0;k<m;k++) row[i0+(b+k)*stride] = escape_value(v,out[k],zr[k],zi[k]);
+    }
+}
+
+/* rows are independent, so full and coarse passes hand them to the pool */
+static Pool *g_pool;
+void frac_set_pool(Pool *p){ g_pool=p; }
+
+typedef struct {
+    const FracView *v; int *iters;
+    int step, prev_step;
+    FracAbort ab; void *ab_ctx;
+    volatile int aborted;   // set once by any row; later rows are skipped
+} RowJob;
+
+static void row_task(void *ctx, int task){
+    RowJob *r=(RowJob*)ctx;
+    const FracView *v=r->v;
+    const int step=r->step, prev=r->prev_step, j=task*step;
+    if(r->aborted) return;
+    if(r->ab && r->ab(r->ab_ctx)){ r->aborted=1; return; }
+    int *row = r->iters + (size_t)j*v->w;
+    if(prev>0 && j%prev==0){   // keep the previous pass' samples on this row
+        int odd = (v->w - step + prev-1)/prev;
+        if(odd>0) escape_span(v,j,step,prev,odd,row);
+    }else{
+        escape_span(v,j,0,step,(v->w + step-1)/step,row);
+    }
+}
+
+void frac_jitter(int s, double *di, double *dj){
+    const double g1=0.7548776662466927, g2=0.5698402909980532;   // 1/phi2, 1/phi2^2
+    *di = fmod(0.5 + (s+1)*g1, 1.0) - 0.5;
+    *dj = fmod(0.5 + (s+1)*g2, 1.0) - 0.5;
+}
+
+typedef struct {
+    FracView sv[FRAC_MAX_SAMPLES];   // the view shifted to each sample point
+    const unsigned char *mark; int n; int *out;
+} SampleJob;
+
+static void sample_row(void *ctx, int j){
+    const SampleJob *J=(const SampleJob*)ctx;
+    const int w=J->sv[0].w;
+    for(int i=0;i<w;i++){
+        const size_t k=(size_t)j*w+i;
+        if(!J->mark[k]) continue;
+        for(int s=0;s<J->n;s++) J->out[k*J->n+s] = frac_escape(&J->sv[s],i,j);
+    }
+}
+
+void frac_render_samples(const FracView *v, const unsigned char *mark, int n, int *out){
+    if(n>FRAC_MAX_SAMPLES) n=FRAC_MAX_SAMPLES;
+    SampleJob J;
+    for(int s=0;s<n;s++){
+        J.sv[s]=*v;
+        frac_jitter(s,&J.sv[s].sub_i,&J.sv[s].sub_j);
+    }
+    J.mark=mark; J.n=n; J.out=out;
+    pool_for(g_pool,v->h,sample_row,&J);
+}
+
+long frac_render_brute(const FracView *v, int *iters){
+    RowJob r={ v, iters, 1, 0, NULL, NULL, 0 };
+    pool_for(g_pool,v->h,row_task,&r);
+    return (long)v->w * v->h;
+}
+
+// ---- Mariani-Silver: iterate a rect's border, flood it if uniform, else split
+typedef struct { const FracView *v; int *it; long n; int unit; } Subdiv;
+
+// smooth counts are compared by whole iteration: their fractions never match
+static int sd_get(Subdiv *s, int i, int j){
+    int *p = &s->it[(size_t)j*s->v->w + i];
+    if(*p==FRAC_TODO){ *p = frac_escape(s->v,i,j); s->n++; }
+    return *p / s->unit;
+}
+
+static int sd_border_uniform(Subdiv *s, int x0, int y0, int x1, int y1){
+    int ref = sd_get(s,x0,y0);
+    for(int i=x0;i<=x1;i++) if(sd_get(s,i,y0)!=ref || sd_get(s,i,y1)!=ref) return 0;
+    for(int j=y0+1;j<y1;j++) if(sd_get(s,x0,j)!=ref || sd_get(s,x1,j)!=ref) return 0;
+    return 1;
+}
+
+/* a smooth exterior band is filled with the mean of the border lerped
+   across each row and each column, which stays inside the band */
+static void sd_fill(Subdiv *s, int x0, int y0, int x1, int y1){
+    const int w=s->v->w, ref=s->it[(size_t)y0*w + x0];
+    int *it=s->it;
+    if(s->unit==1 || ref>=frac_inside(s->v)){
+        for(int j=y0+1;j<y1;j++)
+            for(int i=x0+1;i<x1;i++) it[(size_t)j*w + i] = ref;
+        return;
+    }
+    for(int j=y0+1;j<y1;j++){
+        const double v=(double)(j-y0)/(y1-y0), l=it[(size_t)j*w + x0], r=it[(size_t)j*w + x1];
+        for(int i=x0+1;i<x1;i++){
+            const double u=(double)(i-x0)/(x1-x0), t=it[(size_t)y0*w + i], b=it[(size_t)y1*w + i];
+            it[(size_t)j*w + i] = (int)lrint(0.5*(l + u*(r-l) + t + v*(b-t)));
+        }
+    }
+}
+
+static void sd_rect(Subdiv *s, int x0, int y0, int x1, int y1){
+    if(x1-x0<2 || y1-y0<2){   // no interior: just make sure every cell is done
+        for(int j=y0;j<=y1;j++) for(int i=x0;i<=x1;i++) sd_get(s,i,j);
+        return;
+    }
+    if(sd_border_uniform(s,x0,y0,x1,y1)){ sd_fill(s,x0,y0,x1,y1); return; }
+    if(x1-x0<=SD_MIN_SPAN || y1-y0<=SD_MIN_SPAN){   // border scan may have stopped early
+        for(int j=y0;j<=y1;j++) for(int i=x0;i<=x1;i++) sd_get(s,i,j);
+        return;
+    }
+    // split the longer side; halves share the middle line so it's iterated once
+    if(x1-x0 >= y1-y0){
+        int xm=(x0+x1)/2;
+        sd_rect(s,x0,y0,xm,y1); sd_rect(s,xm,y0,x1,y1);
+    }else{
+        int ym=(y0+y1)/2;
+        sd_rect(s,x0,y0,x1,ym); sd_rect(s,x0,ym,x1,y1);
+    }
+}
+
+long frac_render_subdiv(const FracView *v, int *iters){
+    if(v->w<=0 || v->h<=0) return 0;
+    size_t n=(size_t)v->w*v->h;
+    for(size_t k=0;k<n;k++) iters[k]=FRAC_TODO;
+    Subdiv s={ v, iters, 0, v->smooth ? FRAC_SMOOTH : 1 };
+    sd_rect(&s,0,0,v->w-1,v->h-1);
+    return s.n;
+}
+
+long frac_compare(const int *a, const int *b, size_t n, int unit){
+    long bad=0;
+    for(size_t k=0;k<n;k++) if(a[k]/unit!=b[k]/unit) bad++;
+    return bad;
+}
+
+long frac_render_step(const FracView *v, int *iters, int step, int prev_step, FracAbort ab, void *ctx){
+    if(step<1) step=1;
+    RowJob r={ v, iters, step, prev_step, ab, ctx, 0 };
+    pool_for(g_pool,(v->h + step-1)/step,row_task,&r);
+    if(r.aborted) return -1;
+    long n=0;
+    for(int j=0;j<v->h;j+=step){
+        if(prev_step>0 && j%prev_step==0){ int odd=(v->w - step + prev_step-1)/prev_step; if(odd>0) n+=odd; }
+        else n += (v->w + step-1)/step;
+    }
+    if(step>1){
+        for(int j=0;j<v->h;j++){
+            const int *src = iters + (size_t)(j - j%step)*v->w;
+            int *dst = iters + (size_t)j*v->w;
+            for(int i=0;i<v->w;i++) dst[i] = src[i - i%step];
+        }
+    }
+    return n;
+}
+
+int frac_view_eq(const FracView *a, const FracView *b){
+    return a->w==b->w && a->h==b->h && a->cx==b->cx && a->cy==b->cy && a->scale==b->scale &&
+           a->julia==b->julia && a->j_re==b->j_re && a->j_im==b->j_im && a->max_iter==b->max_iter &&
+           a->smooth==b->smooth && a->sub_i==b->sub_i && a->sub_j==b->sub_j && a->formula==b->formula && a->power==b->power && a->seq==b->seq && a->seq_len==b->seq_len &&
+           a->prec==b->prec && a->series==b->series && mp_eq(&a->hcx,&b->hcx) && mp_eq(&a->hcy,&b->hcy);
+}
+
+/* a kernel is trusted while a cell spans at least 2^12 of its ulps at the
+   view's magnitude; the headroom absorbs error growth over the orbit */
+FracPrec frac_pick_prec(const FracView *v, FracPrec want){
+    if(want==FRAC_PREC_PERTURB && v->formula!=FRAC_Z2) return FRAC_PREC_DD;   // reference orbits are z^2 only
+    if(want!=FRAC_PREC_AUTO) return want;
+    double mag = fabs(v->cx)>fabs(v->cy) ? fabs(v->cx) : fabs(v->cy);
+    if(mag<1.0) mag=1.0;
+    double cell = v->scale/(v->w>1?v->w:1) / mag;
+    // a cell must span enough ulps to absorb the rounding drift of a full orbit
+    double ulps = 16.0*v->max_iter;
+    if(ulps<4096.0) ulps=4096.0;
+    if(cell >= ulps*FLT_EPSILON) return FRAC_PREC_FLOAT;
+    if(cell >= ulps*DBL_EPSILON) return FRAC_PREC_DOUBLE;
+    if(cell >= ulps*DBL_EPSILON*DBL_EPSILON || v->formula!=FRAC_Z2) return FRAC_PREC_DD;
+    return FRAC_PREC_PERTURB;
+}
+
+void frac_view_set_center(FracView *v, const Mp *hcx, const Mp *hcy){
+    Mp r;
+    v->hcx=*hcx; v->hcy=*hcy;
+    v->cx=mp_to_double(hcx); r=*hcx; mp_add_double(&r,-v->cx); v->cx_lo=mp_to_double(&r);
+    v->cy=mp_to_double(hcy); r=*hcy; mp_add_double(&r,-v->cy); v->cy_lo=mp_to_double(&r);
+}
+
+// ---- reference orbit + series approximation -------------------------------
+#define SA_TOL 1e-12   // allowed 3rd-order term relative to the 1st-order one
+
+static int ref_reserve(FracRef *ref, int n){
+    if(n<=ref->cap) return 0;
+    double *zr=(double*)realloc(ref->zr,(size_t)n*sizeof(double)); if(!zr) return -1;
+    ref->zr=zr;
+    double *zi=(double*)realloc(ref->zi,(size_t)n*sizeof(double)); if(!zi) return -1;
+    ref->zi=zi;
+    ref->cap=n;
+    return 0;
+}
+
+static void ref_series(FracRef *ref, const FracView *v){
+    const double ar = (double)v->h/(double)(v->w>0?v->w:1);
+    const double d = 0.5*v->scale*sqrt(1.0+ar*ar);   // largest |dc| in the view
+    double Ar=v->julia?1:0, Ai=0, Br=0, Bi=0, Cr=0, Ci=0;
+    ref->skip=0;
+    if(!v->series) return;
+    for(int n=0;n<ref->len-1;n++){
+        double zr=ref->zr[n], zi=ref->zi[n];
+        // A' = 2ZA (+1), B' = 2ZB + A^2, C' = 2ZC + 2AB
+        double nAr = 2*(zr*Ar - zi*Ai) + (v->julia?0:1), nAi = 2*(zr*Ai + zi*Ar);
+        double nBr = 2*(zr*Br - zi*Bi) + Ar*Ar - Ai*Ai, nBi = 2*(zr*Bi + zi*Br) + 2*Ar*Ai;
+        double nCr = 2*(zr*Cr - zi*Ci) + 2*(Ar*Br - Ai*Bi), nCi = 2*(zr*Ci + zi*Cr) + 2*(Ar*Bi + Ai*Br);
+        double ma=hypot(nAr,nAi), mb=hypot(nBr,nBi), mc=hypot(nCr,nCi);
+        if(!isfinite(ma+mb+mc) || mc*d*d*d > SA_TOL*ma*d) break;
+        // no cell may escape inside the skipped range
+        if(hypot(ref->zr[n+1],ref->zi[n+1]) + ma*d + mb*d*d + mc*d*d*d > 2.0) break;
+        Ar=nAr; Ai=nAi; Br=nBr; Bi=nBi; Cr=nCr; Ci=nCi;
+        ref->skip=n+1;
+    }
+    ref->a_re=Ar; ref->a_im=Ai; ref->b_re=Br; ref->b_im=Bi; ref->c_re=Cr; ref->c_im=Ci;
+}
+
+int frac_ref_prepare(FracRef *ref, const FracView *v){
+    if(ref_reserve(ref,v->max_iter+1)) return -1;
+    Mp zr, zi, cr, ci, zr2, zi2, zri;
+    if(v->julia){ zr=v->hcx; zi=v->hcy; mp_from_double(&cr,v->j_re); mp_from_double(&ci,v->j_im); }
+    else        { mp_zero(&zr); mp_zero(&zi); cr=v->hcx; ci=v->hcy; }
+    ref->zr[0]=mp_to_double(&zr); ref->zi[0]=mp_to_double(&zi);
+    ref->len=0;
+    while(ref->len<v->max_iter){
+        mp_mul(&zr2,&zr,&zr); mp_mul(&zi2,&zi,&zi); mp_mul(&zri,&zr,&zi);
+        mp_sub(&zr,&zr2,&zi2); mp_add(&zr,&zr,&cr);
+        mp_add(&zi,&zri,&zri); mp_add(&zi,&zi,&ci);
+        int n=++ref->len;
+        ref->zr[n]=mp_to_double(&zr); ref->zi[n]=mp_to_double(&zi);
+        if(ref->zr[n]*ref->zr[n] + ref->zi[n]*ref->zi[n] > 4.0) break;
+    }
+    ref_series(ref,v);
+    return 0;
+}
+
+void frac_ref_free(FracRef *ref){
+    free(ref->zr); free(ref->zi);
+    ref->zr=ref->zi=NULL; ref->cap=ref->len=0;
+}
+
+// ---- resumable orbits ------------------------------------------------------
+static int orbit_reserve(FracOrbit *o, long n){
+    if(n<=o->cap) return 0;
+    double **dp[4] = { &o->zr, &o->zi, &o->zr_lo, &o->zi_lo };
+    int **ip[3] = { &o->cnt, &o->m, &o->todo };
+    for(int k=0;k<4;k++){
+        double *p=(double*)realloc(*dp[k],(size_t)n*sizeof(double)); if(!p) return -1;
+        *dp[k]=p;
+    }
+    for(int k=0;k<3;k++){
+        int *p=(int*)realloc(*ip[k],(size_t)n*sizeof(int)); if(!p) return -1;
+        *ip[k]=p;
+    }
+    o->cap=n;
+    return 0;
+}
+
+int frac_orbit_reset(FracOrbit *o, const FracView *v, int *iters){
+    long n=(long)v->w*v->h;
+    if(orbit_reserve(o,n)) return -1;
+    o->pending=0; o->iter=0;
+    for(int j=0;j<v->h;j++) for(int i=0;i<v->w;i++){
+        long k=(long)j*v->w+i;
+        int out=0;
+        o->cnt[k]=0; o->m[k]=0; o->zr_lo[k]=o->zi_lo[k]=0;
+        if(v->prec==FRAC_PREC_PERTURB && v->ref){
+            out=perturb_init(v,i,j,&o->zr[k],&o->zi[k],&o->m[k]);
+            if(!out) o->cnt[k]=o->m[k];
+        }else if(v->prec==FRAC_PREC_DD){
+            DD x,y; dd_init(v,i,j,&x,&y);
+            o->zr[k]=x.hi; o->zr_lo[k]=x.lo; o->zi[k]=y.hi; o->zi_lo[k]=y.lo;
+        }else{
+            double cr,ci; lanes_seed(v,i,j,&o->zr[k],&o->zi[k],&cr,&ci);
+        }
+        if(out) iters[k]=0;
+        else { iters[k]=frac_inside(v); o->todo[o->pending++]=(int)k; }
+    }
+    return 0;
+}
+
+long frac_orbit_advance(FracOrbit *o, const FracView *v, int budget, int *iters){
+    const long start=o->pending;
+    const int max=v->max_iter;
+    int limit = budget<max-o->iter ? o->iter+budget : max;
+    long kept=0;
+    if(v->prec==FRAC_PREC_FLOAT || v->prec==FRAC_PREC_DOUBLE){
+        double zr[SPAN_CHUNK], zi[SPAN_CHUNK], cr[SPAN_CHUNK], ci[SPAN_CHUNK];
+        int cnt[SPAN_CHUNK]; unsigned char live[SPAN_CHUNK];
+        const OrbitLanes run = orbit_lanes(v);
+        for(long b=0;b<start;b+=SPAN_CHUNK){
+            int m = start-b<SPAN_CHUNK ? (int)(start-b) : SPAN_CHUNK;
+            for(int k=0;k<m;k++){
+                int c=o->todo[b+k];
+                zr[k]=o->zr[c]; zi[k]=o->zi[c]; cnt[k]=o->cnt[c]; live[k]=1;
+                if(v->julia){ cr[k]=v->j_re; ci[k]=v->j_im; }
+                else frac_pixel(v,c%v->w,c/v->w,&cr[k],&ci[k]);
+            }
+            run(zr,zi,cr,ci,cnt,live,m,max,limit-o->iter);
+            for(int k=0;k<m;k++){
+                int c=o->todo[b+k];
+                o->zr[c]=zr[k]; o->zi[c]=zi[k]; o->cnt[c]=cnt[k];
+                if(live[k]) o->todo[kept++]=c;
+                else iters[c]=escape_value(v,cnt[k],zr[k],zi[k]);
+            }
+        }
+    }else{
+        for(long b=0;b<start;b++){
+            int c=o->todo[b], i=c%v->w, j=c/v->w, out;
+            double zr, zi;
+            if(v->prec==FRAC_PREC_PERTURB && v->ref){
+                out=perturb_run(v,i,j,&o->zr[c],&o->zi[c],&o->m[c],&o->cnt[c],limit);
+                zr=v->ref->zr[o->m[c]]+o->zr[c]; zi=v->ref->zi[o->m[c]]+o->zi[c];
+            }else{
+                DD x={ o->zr[c], o->zr_lo[c] }, y={ o->zi[c], o->zi_lo[c] };
+                out=dd_run(v,i,j,&x,&y,&o->cnt[c],limit);
+                o->zr[c]=x.hi; o->zr_lo[c]=x.lo; o->zi[c]=y.hi; o->zi_lo[c]=y.lo;
+                zr=x.hi; zi=y.hi;
+            }
+            if(!out && o->cnt[c]<max) o->todo[kept++]=c;
+            else iters[c]=out ? escape_value(v,o->cnt[c],zr,zi) : frac_inside(v);
+        }
+    }
+    o->pending=kept;
+    o->iter=limit;
+    return start;
+}
+
+void frac_orbit_free(FracOrbit *o){
+    free(o->zr); free(o->zi); free(o->zr_lo); free(o->zi_lo);
+    free(o->cnt); free(o->m); free(o->todo);
+    o->zr=o->zi=o->zr_lo=o->zi_lo=NULL; o->cnt=o->m=o->todo=NULL;
+    o->cap=o->pending=0;
+}
+
+// ---- viewport cache ---------------------------------------------------------
+#define CACHE_SCALE_TOL 1e-9   // relative; zoom out undoes zoom in to within an ulp or two
+#define CACHE_CELL_TOL  (1.0/64)
+
+static int view_near(const FracView *a, const FracView *b){
+    if(a->w!=b->w || a->h!=b->h || a->julia!=b->julia || a->j_re!=b->j_re || a->j_im!=b->j_im ||
+       a->max_iter!=b->max_iter || a->smooth!=b->smooth || a->formula!=b->formula || a->power!=b->power ||
+       a->seq!=b->seq || a->seq_len!=b->seq_len ||
+       a->prec!=b->prec || a->series!=b->series) return 0;
+    if(fabs(a->scale-b->scale) > CACHE_SCALE_TOL*a->scale) return 0;
+    double tol = CACHE_CELL_TOL*a->scale/(a->w>1?a->w:1);
+    Mp d;
+    mp_sub(&d,&a->hcx,&b->hcx); if(fabs(mp_to_double(&d)) > tol) return 0;
+    mp_sub(&d,&a->hcy,&b->hcy); if(fabs(mp_to_double(&d)) > tol) return 0;
+    return 1;
+}
+
+static void cache_drop(FracCache *c, int k){
+    c->bytes -= (size_t)c->e[k].v.w*c->e[k].v.h*sizeof(int);
+    free(c->e[k].iters);
+    c->e[k] = c->e[--c->count];
+}
+
+int frac_cache_get(FracCache *c, const FracView *v, int *iters){
+    if(!c->limit) return 0;
+    for(int k=0;k<c->count;k++){
+        if(!view_near(&c->e[k].v,v)) continue;
+        memcpy(iters,c->e[k].iters,(size_t)v->w*v->h*sizeof(int));
+        c->e[k].used = ++c->tick;
+        c->hits++;
+        return 1;
+    }
+    c->misses++;
+    return 0;
+}
+
+void frac_cache_put(FracCache *c, const FracView *v, const int *iters){
+    size_t sz=(size_t)v->w*v->h*sizeof(int);
+    if(!c->limit || sz>c->limit) return;
+    for(int k=0;k<c->count;k++) if(view_near(&c->e[k].v,v)){ c->e[k].used = ++c->tick; return; }
+    while(c->count && c->bytes+sz > c->limit){   // evict least recently used
+        int old=0;
+        for(int k=1;k<c->count;k++) if(c->e[k].used < c->e[old].used) old=k;
+        cache_drop(c,old);
+    }
+    if(c->count==c->cap){
+        int ncap = c->cap ? c->cap*2 : 16;
+        FracCacheEntry *e=(FracCacheEntry*)realloc(c->e,(size_t)ncap*sizeof(*e)); if(!e) return;
+        c->e=e; c->cap=ncap;
+    }
+    int *buf=(int*)malloc(sz); if(!buf) return;
+    memcpy(buf,iters,sz);
+    FracCacheEntry *e=&c->e[c->count++];
+    e->v=*v; e->v.ref=NULL;
+    e->iters=buf; e->used=++c->tick;
+    c->bytes+=sz;
+}
+
+void frac_cache_free(FracCache *c){
+    while(c->count) cache_drop(c,c->count-1);
+    free(c->e);
+    c->e=NULL; c->cap=0; c->bytes=0;
+}
+
+// ---- histogram equalization ------------------------------------------------
+typedef struct {
+    FracEq *e; const int *iters; size_t n; int inside;
+    int lo[FRAC_EQ_TASKS], hi[FRAC_EQ_TASKS];
+} EqJob;
+
+static void eq_range_task(void *ctx, int task){
+    EqJob *J=(EqJob*)ctx;
+    const size_t k0=J->n*task/FRAC_EQ_TASKS, k1=J->n*(task+1)/FRAC_EQ_TASKS;
+    int lo=INT_MAX, hi=INT_MIN;
+    for(size_t k=k0;k<k1;k++){
+        int it=J->iters[k];
+        if(it>=J->inside || it<0) continue;
+        if(it<lo) lo=it;
+        if(it>hi) hi=it;
+    }
+    J->lo[task]=lo; J->hi[task]=hi;
+}
+
+static void eq_count_task(void *ctx, int task){
+    EqJob *J=(EqJob*)ctx;
+    const size_t k0=J->n*task/FRAC_EQ_TASKS, k1=J->n*(task+1)/FRAC_EQ_TASKS;
+    unsigned *bins=J->e->part + (size_t)task*FRAC_EQ_BINS;
+    const int lo=J->e->lo;
+    const double per=(double)FRAC_EQ_BINS/((double)J->e->hi - lo + 1);
+    memset(bins,0,FRAC_EQ_BINS*sizeof(unsigned));
+    for(size_t k=k0;k<k1;k++){
+        int it=J->iters[k];
+        if(it>=J->inside || it<0) continue;
+        bins[(int)((it-lo)*per)]++;
+    }
+}
+
+int frac_eq_build(FracEq *e, const int *iters, size_t n, int inside){
+    if(!e->part){
+        e->part=(unsigned*)malloc((size_t)FRAC_EQ_TASKS*FRAC_EQ_BINS*sizeof(unsigned));
+        if(!e->part) return -1;
+    }
+    EqJob J;
+    J.e=e; J.iters=iters; J.n=n; J.inside=inside;
+    pool_for(g_pool,FRAC_EQ_TASKS,eq_range_task,&J);
+    e->lo=INT_MAX; e->hi=INT_MIN;
+    for(int t=0;t<FRAC_EQ_TASKS;t++){
+        if(J.lo[t]<e->lo) e->lo=J.lo[t];
+        if(J.hi[t]>e->hi) e->hi=J.hi[t];
+    }
+    if(e->lo>e->hi){ e->lo=0; e->hi=0; }   // nothing escaped
+    pool_for(g_pool,FRAC_EQ_TASKS,eq_count_task,&J);
+    unsigned long total=0;
+    for(int b=0;b<FRAC_EQ_BINS;b++){
+        e->cdf[b]=(float)total;
+        for(int t=0;t<FRAC_EQ_TASKS;t++) total += e->part[(size_t)t*FRAC_EQ_BINS + b];
+    }
+    e->cdf[FRAC_EQ_BINS]=(float)total;
+    const float norm = total ? 1.0f/(float)total : 0;
+    for(int b=0;b<=FRAC_EQ_BINS;b++) e->cdf[b]*=norm;
+    return 0;
+}
+
+// rank of value among the escaped cells, interpolated inside its bin
+double frac_eq_map(const FracEq *e, int value){
+    if(value<=e->lo) return 0;
+    if(value>=e->hi) return e->cdf[FRAC_EQ_BINS];
+    double pos=(double)(value - e->lo)*FRAC_EQ_BINS/((double)e->hi - e->lo + 1);
+    int b=(int)pos;
+    return e->cdf[b] + (e->cdf[b+1]-e->cdf[b])*(pos-b);
+}
+
+void frac_eq_free(FracEq *e){
+    free(e->part);
+    e->part=NULL;
+}
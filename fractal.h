@@ -0,0 +1,152 @@
+#ifndef FRACTAL_H
+#define FRACTAL_H
+#include <stddef.h>
+#include "mp.h"
+#include "pool.h"
+
+/* kernel precision; AUTO is resolved by frac_pick_prec() before rendering */
+typedef enum {
+    FRAC_PREC_AUTO=0,
+    FRAC_PREC_FLOAT,     // float32 lanes, shallow views
+    FRAC_PREC_DOUBLE,
+    FRAC_PREC_DD,        // double-double, down to ~1e-28
+    FRAC_PREC_PERTURB    // Mp reference orbit + double deltas (FRAC_Z2 only)
+} FracPrec;
+
+#define FRAC_DEEP_MIN_SCALE 1e-72   // perturbation deltas stay well above the Mp resolution
+
+/* perturbation reference: orbit of the view center in Mp, stored as doubles */
+typedef struct {
+    double *zr, *zi;        // Z_0..Z_len
+    int     len, cap;
+    int     skip;           // iterations covered by the series approximation
+    double  a_re, a_im, b_re, b_im, c_re, c_im;   // series coefficients at skip
+} FracRef;
+
+/* iteration formula z -> f(z) + c; each one is a separate compiled kernel */
+typedef enum {
+    FRAC_Z2=0,       // mandelbrot / julia
+    FRAC_ZPOW,       // multibrot z^power, 2..FRAC_MAX_POWER
+    FRAC_SHIP,       // burning ship: (|re z| + i|im z|)^2
+    FRAC_TRICORN,    // conj(z)^2
+    FRAC_LYAPUNOV    // not an escape kernel: logistic-map exponent, lyapunov.c
+} FracFormula;
+
+#define FRAC_MAX_POWER 8
+#define FRAC_SMOOTH    256   // sub-steps per iteration of a smooth escape count
+#define FRAC_MAX_ITER  8000000   // keeps max_iter*FRAC_SMOOTH inside an int
+
+/* escape-time view: maps a w x h cell grid onto the complex plane */
+typedef struct {
+    int    w, h;
+    double cx, cy;
+    double scale;      // view width in plane units (height follows the cell aspect)
+    FracFormula formula;
+    int    power;      // FRAC_ZPOW exponent
+    unsigned seq;      // FRAC_LYAPUNOV A/B pattern (bit k set = B), seq_len steps long
+    int    seq_len;
+    int    julia;      // 0: c = pixel, z0 = 0; 1: c = (j_re,j_im), z0 = pixel
+    double j_re, j_im;
+    int    max_iter;
+    int    smooth;     // iters count in 1/FRAC_SMOOTH steps, continuous across escape bands
+    double sub_i, sub_j;  // where in its cell each sample sits, in cells from the center
+    Mp     hcx, hcy;   // full-precision center; cx/cy are its double rounding
+    double cx_lo, cy_lo;  // hcx - cx, hcy - cy (double-double kernel)
+    FracPrec prec;
+    int    series;     // perturbation: skip early iterations via series approximation
+    const FracRef *ref;   // set for FRAC_PREC_PERTURB once frac_ref_prepare() ran
+} FracView;
+
+typedef enum { FRAC_BRUTE=0, FRAC_SUBDIV=1 } FracMethod;
+
+/* per-cell orbit state, so a large max_iter can be spread over many frames */
+typedef struct {
+    double *zr, *zi;        // z (perturbation: the delta dz)
+    double *zr_lo, *zi_lo;  // low parts for the double-double kernel
+    int    *cnt, *m;        // iterations done; perturbation reference index
+    int    *todo;           // cells still iterating, pending of them
+    long    pending, cap;
+    int     iter;           // iterations every pending cell has had
+} FracOrbit;
+
+/* polled between rows of a refinement pass; nonzero aborts the pass */
+typedef int (*FracAbort)(void *ctx);
+
+void frac_pixel(const FracView *v, int i, int j, double *x, double *y);
+int  frac_escape(const FracView *v, int i, int j);
+int  frac_inside(const FracView *v);   // iters value of cells that reached max_iter
+
+/* supersampling. sample s of the jitter pattern sits (di,dj) cells off the
+   center, within +-0.5; the points follow the R2 sequence, so any count
+   covers a cell evenly and a still view gets the same samples each frame */
+#define FRAC_MAX_SAMPLES 16
+void frac_jitter(int s, double *di, double *dj);
+/* n extra samples of each cell with mark[] set into out[k*n + s]; rows are
+   spread over the pool */
+void frac_render_samples(const FracView *v, const unsigned char *mark, int n, int *out);
+
+/* pool the full and coarse passes spread their rows over (NULL = serial) */
+void frac_set_pool(Pool *p);
+
+/* fill iters[w*h] (row-major); return the number of cells actually iterated */
+long frac_render_brute(const FracView *v, int *iters);
+/* Mariani-Silver. smooth counts fill a uniform border's band by
+   interpolation, so they match brute force by whole iteration only */
+long frac_render_subdiv(const FracView *v, int *iters);
+long frac_compare(const int *a, const int *b, size_t n, int unit);  // cells whose value/unit differ
+
+/* coarse pass: iterate every step-th cell and draw it as a step x step block.
+   samples already taken by a pass at prev_step (0 or 2*step) are kept.
+   returns cells iterated, or -1 if ab() asked to stop (buffer left partial) */
+long frac_render_step(const FracView *v, int *iters, int step, int prev_step, FracAbort ab, void *ctx);
+int  frac_view_eq(const FracView *a, const FracView *b);
+
+/* start the orbits of every cell; iters[] shows cells still iterating as
+   max_iter (inside) until they resolve. -1 on allocation failure */
+int  frac_orbit_reset(FracOrbit *o, const FracView *v, int *iters);
+/* advance pending orbits by up to budget iterations and write those that
+   escaped or hit max_iter; returns the cells advanced */
+long frac_orbit_advance(FracOrbit *o, const FracView *v, int budget, int *iters);
+void frac_orbit_free(FracOrbit *o);
+
+/* LRU of finished iteration buffers; views match within a small fraction
+   of a cell, so zooming back out or panning back lands on an entry */
+typedef struct {
+    FracView v;
+    int     *iters;
+    unsigned long used;     // LRU stamp
+} FracCacheEntry;
+
+typedef struct {
+    FracCacheEntry *e;
+    int     count, cap;
+    size_t  bytes, limit;   // bytes held by buffers, cap (0 = cache off)
+    unsigned long tick;
+    long    hits, misses;
+} FracCache;
+
+int  frac_cache_get(FracCache *c, const FracView *v, int *iters);   // 1 on hit, iters filled
+void frac_cache_put(FracCache *c, const FracView *v, const int *iters);
+void frac_cache_free(FracCache *c);
+
+/* histogram equalization: escaped cells spread over 0..1 by rank, so a
+   deep view still uses the whole ramp. the histogram is counted in
+   FRAC_EQ_TASKS slices over the pool and then merged */
+#define FRAC_EQ_BINS  1024
+#define FRAC_EQ_TASKS 16
+
+typedef struct {
+    int       lo, hi;                  // range of the escaped values
+    float     cdf[FRAC_EQ_BINS+1];     // share of escaped cells below each bin edge
+    unsigned *part;                    // per-task bins
+} FracEq;
+
+int    frac_eq_build(FracEq *e, const int *iters, size_t n, int inside);   // -1 on allocation failure
+double frac_eq_map(const FracEq *e, int value);
+void   frac_eq_free(FracEq *e);
+
+void frac_view_set_center(FracView *v, const Mp *hcx, const Mp *hcy);   // also sets cx/cy and the lo parts
+FracPrec frac_pick_prec(const FracView *v, FracPrec want);
+int  frac_ref_prepare(FracRef *ref, const FracView *v);   // -1 on allocation failure
+void frac_ref_free(FracRef *ref);
+#endif
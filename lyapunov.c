@@ -0,0 +1,177 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+#include "lyapunov.h"
+#include "vec.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LYAP_MIN_LAMBDA (-8.0)   // superstable cells (a factor of exactly 0) clamp here
+#define LYAP_FOLD 8              // factors multiplied together per log
+
+int lyap_parse_seq(const char *s, unsigned *bits, int *len){
+    unsigned b=0; int n=0;
+    for(;*s;s++){
+        if(*s==' ' || *s=='\t') continue;
+        if(n>=LYAP_MAX_SEQ) return 0;
+        if(*s=='A' || *s=='a') n++;
+        else if(*s=='B' || *s=='b') b |= 1u<<n++;
+        else return 0;
+    }
+    if(!n) return 0;
+    *bits=b; *len=n;
+    return 1;
+}
+
+void lyap_seq_str(unsigned bits, int len, char *out){
+    for(int k=0;k<len;k++) out[k] = (bits>>k & 1) ? 'B' : 'A';
+    out[len]=0;
+}
+
+static int lyap_quantize(double lambda){
+    if(isnan(lambda) || lambda>8.0) lambda=8.0;   // r > 4 sends x off to infinity
+    else if(lambda<LYAP_MIN_LAMBDA) lambda=LYAP_MIN_LAMBDA;
+    return (int)lrint(lambda*LYAP_SCALE);
+}
+
+/* the exponent is the mean of log|r(1-2x)|; the factors are multiplied
+   LYAP_FOLD at a time so only every LYAP_FOLD-th step pays for a log */
+#if defined(__GNUC__)
+#define LYAP_LANES (FRAC_VEC_BYTES/8)
+
+/* natural log of positive normal lanes: split off the exponent, then
+   log(m) = 2 atanh(s), s = (m-1)/(m+1), with m in [sqrt(1/2), sqrt(2)) */
+static vf64 vlog(vf64 x){
+    const vi64 bits=(vi64)x;
+    vi64 e = ((bits>>52) & 0x7ff) - 1023;
+    vf64 m = (vf64)((bits & 0x000fffffffffffffLL) | 0x3ff0000000000000LL);
+    vi64 big = m > 1.4142135623730951;
+    m = (vf64)(((vi64)(m*0.5) & big) | ((vi64)m & ~big));
+    e -= big;   // lanes of a comparison are -1 when true
+    vf64 s=(m-1)/(m+1), s2=s*s;
+    vf64 p = 2*s*(1 + s2*(1.0/3 + s2*(1.0/5 + s2*(1.0/7 + s2*(1.0/9 + s2*(1.0/11 + s2*(1.0/13)))))));
+    vf64 ef;
+    for(int k=0;k<LYAP_LANES;k++) ef[k]=(double)e[k];
+    return ef*0.6931471805599453 + p;
+}
+
+static void lyap_row(const FracView *v, int j, int *out){
+    const int warm=v->max_iter/4, steps=v->max_iter>0 ? v->max_iter : 1;
+    const int len=v->seq_len>0 ? v->seq_len : 1;
+    const vf64 one=(vf64){ 0 }+1, least=(vf64){ 0 }+1e-300;
+    for(int i0=0;i0<v->w;i0+=LYAP_LANES){
+        vf64 a, b, x, sum, prod;
+        for(int k=0;k<LYAP_LANES;k++){
+            double pa,pb; frac_pixel(v, i0+k<v->w ? i0+k : v->w-1, j, &pa, &pb);
+            a[k]=pa; b[k]=pb; x[k]=0.5; sum[k]=0; prod[k]=1;
+        }
+        int s=0;
+        for(int n=0;n<warm;n++){
+            vf64 r = (v->seq>>s & 1) ? b : a;
+            x = r*x*(1-x);
+            if(++s==len) s=0;
+        }
+        for(int n=0;n<steps;n++){
+            vf64 r = (v->seq>>s & 1) ? b : a;
+            vf64 d = r*(1-2*x);
+            prod *= (vf64)((vi64)d & ~(vi64)(-(vf64){ 0 }));   // |d|
+            x = r*x*(1-x);
+            if(++s==len) s=0;
+            if((n % LYAP_FOLD)==LYAP_FOLD-1 || n==steps-1){
+                // a product that hit 0 (or denormal) is a superstable cell
+                vi64 tiny = prod < 1e-300;
+                prod = (vf64)(((vi64)least & tiny) | ((vi64)prod & ~tiny));
+                sum += vlog(prod);
+                prod = one;
+            }
+        }
+        for(int k=0;k<LYAP_LANES && i0+k<v->w;k++) out[(size_t)j*v->w+i0+k]=lyap_quantize(sum[k]/steps);
+    }
+}
+#else
+static void lyap_row(const FracView *v, int j, int *out){
+    const int warm=v->max_iter/4, steps=v->max_iter>0 ? v->max_iter : 1;
+    const int len=v->seq_len>0 ? v->seq_len : 1;
+    for(int i=0;i<v->w;i++){
+        double a,b; frac_pixel(v,i,j,&a,&b);
+        double x=0.5, sum=0, prod=1;
+        int s=0;
+        for(int n=0;n<warm;n++){ double r=(v->seq>>s & 1)?b:a; x=r*x*(1-x); if(++s==len) s=0; }
+        for(int n=0;n<steps;n++){
+            double r=(v->seq>>s & 1)?b:a;
+            prod *= fabs(r*(1-2*x));
+            x=r*x*(1-x);
+            if(++s==len) s=0;
+            if((n % LYAP_FOLD)==LYAP_FOLD-1 || n==steps-1){
+                sum += log(prod<1e-300 ? 1e-300 : prod);
+                prod=1;
+            }
+        }
+        out[(size_t)j*v->w+i]=lyap_quantize(sum/steps);
+    }
+}
+#endif
+
+typedef struct { const FracView *v; int *out; } LyapJob;
+
+static void lyap_task(void *ctx, int j){
+    const LyapJob *J=(const LyapJob*)ctx;
+    lyap_row(J->v,j,J->out);
+}
+
+void lyap_render(const FracView *v, int *out, Pool *pool){
+    LyapJob J={ v, out };
+    pool_for(pool,v->h,lyap_task,&J);
+}
+
+/* what the folding and vlog stand in for: a log() every step */
+static int lyap_ref(const FracView *v, int i, int j){
+    const int warm=v->max_iter/4, steps=v->max_iter>0 ? v->max_iter : 1;
+    const int len=v->seq_len>0 ? v->seq_len : 1;
+    double a,b; frac_pixel(v,i,j,&a,&b);
+    double x=0.5, sum=0;
+    int s=0;
+    for(int n=0;n<warm;n++){ double r=(v->seq>>s & 1)?b:a; x=r*x*(1-x); if(++s==len) s=0; }
+    for(int n=0;n<steps;n++){
+        double r=(v->seq>>s & 1)?b:a, d=fabs(r*(1-2*x));
+        sum += log(d<1e-300 ? 1e-300 : d);
+        x=r*x*(1-x);
+        if(++s==len) s=0;
+    }
+    return lyap_quantize(sum/steps);
+}
+
+int lyap_check(double *log_err){
+    static const char *const SEQS[] = { "AB", "AABAB", "BBBBBBAAAAAA" };
+    enum { W=64, H=24 };
+    static int out[W*H];
+    FracView v;
+    memset(&v,0,sizeof(v));
+    v.w=W; v.h=H; v.cx=3.0; v.cy=3.0; v.scale=2.0; v.max_iter=400; v.formula=FRAC_LYAPUNOV;
+    int worst=0;
+    for(size_t q=0;q<sizeof(SEQS)/sizeof(SEQS[0]);q++){
+        lyap_parse_seq(SEQS[q],&v.seq,&v.seq_len);
+        for(int j=0;j<H;j++) lyap_row(&v,j,out);
+        for(int j=0;j<H;j++){
+            for(int i=0;i<W;i++){
+                const int d=abs(out[j*W+i]-lyap_ref(&v,i,j));
+                if(d>worst) worst=d;
+            }
+        }
+    }
+    double err=0;
+#if defined(__GNUC__)
+    // every normal double's exponent, a few mantissas each
+    for(double x=1e-300; x<1e300; x*=1.37*LYAP_LANES){
+        vf64 xs, ys;
+        for(int k=0;k<LYAP_LANES;k++) xs[k]=x*pow(1.37,k);
+        ys=vlog(xs);
+        for(int k=0;k<LYAP_LANES;k++){
+            const double r=log(xs[k]), e=fabs(ys[k]-r)/(fabs(r)>1 ? fabs(r) : 1);
+            if(e>err) err=e;
+        }
+    }
+#endif
+    *log_err=err;
+    return worst;
+}
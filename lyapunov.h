@@ -0,0 +1,21 @@
+#ifndef LYAPUNOV_H
+#define LYAPUNOV_H
+#include "fractal.h"
+
+/* lyapunov exponent of the logistic map x -> r x (1-x) over the (a,b)
+   plane, r stepping through an A/B sequence. a view with formula
+   FRAC_LYAPUNOV holds the sequence in seq/seq_len; max_iter steps are
+   averaged after max_iter/4 to settle */
+#define LYAP_MAX_SEQ 32
+#define LYAP_SCALE   1000   // exponents are stored as lrint(lambda * LYAP_SCALE)
+
+/* "AB", "aabab", ...: bit k of *bits set = B at step k. 0 on bad input */
+int  lyap_parse_seq(const char *s, unsigned *bits, int *len);
+void lyap_seq_str(unsigned bits, int len, char *out);   // out holds LYAP_MAX_SEQ+1
+/* fill out[w*h] with the scaled exponents, rows spread over pool */
+void lyap_render(const FracView *v, int *out, Pool *pool);
+/* --check: largest difference, in stored units, between lyap_render's
+   kernel and a log() per step over a few sequences; *log_err gets the
+   lane log's worst relative error against log() */
+int  lyap_check(double *log_err);
+#endif
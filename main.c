@@ -13,8 +13,20 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <ctype.h>
+#include <poll.h>
 #include "util.h"
 #include "terminal.h"
+#include "fractal.h"
+#include "path.h"
+#include "cexpr.h"
+#include "buddha.h"
+#include "lyapunov.h"
+#include "raymarch.h"
+#include "sim.h"
+#include "shape.h"
+#include "dither.h"
+#include "noise.h"
+#include "stats.h"
 
 #define COL_RESET "\x1b[0m"
 #define COL_KEY   "\x1b[1;38;5;208m"   /* orange & bold */
@@ -46,7 +58,59 @@ static const char *COL_EVALUE = NULL;
 // utility and terminal helpers moved to util.c and terminal.c
 
 // ----------------------------- config --------------------------------------
-typedef enum { MODE_EXPR=0, MODE_MANDELBROT=1, MODE_JULIA=2 } ModeType;
+typedef enum { MODE_EXPR=0, MODE_MANDELBROT=1, MODE_JULIA=2, MODE_MULTIBROT=3, MODE_BURNING_SHIP=4, MODE_TRICORN=5, MODE_COMPLEX=6,
+               MODE_BUDDHABROT=7, MODE_NEBULABROT=8, MODE_LYAPUNOV=9, MODE_RAYMARCH=10,
+               MODE_LIFE=11, MODE_GRAYSCOTT=12, MODE_HEAT=13 } ModeType;
+
+/* how a mode renders; dispatch goes by kind, never by the enum's order */
+typedef enum { KIND_EXPR, KIND_ESCAPE, KIND_OWN, KIND_SIM } ModeKind;
+
+/* every escape-time type is one formula with mandelbrot or julia seeding */
+static const struct { const char *name; ModeKind kind; FracFormula formula; int julia; } MODE_INFO[] = {
+    [MODE_EXPR]         = { "expr",         KIND_EXPR,   FRAC_Z2,      0 },
+    [MODE_MANDELBROT]   = { "mandelbrot",   KIND_ESCAPE, FRAC_Z2,      0 },
+    [MODE_JULIA]        = { "julia",        KIND_ESCAPE, FRAC_Z2,      1 },
+    [MODE_MULTIBROT]    = { "multibrot",    KIND_ESCAPE, FRAC_ZPOW,    0 },
+    [MODE_BURNING_SHIP] = { "burning_ship", KIND_ESCAPE, FRAC_SHIP,    0 },
+    [MODE_TRICORN]      = { "tricorn",      KIND_ESCAPE, FRAC_TRICORN, 0 },
+    [MODE_COMPLEX]      = { "complex_iter", KIND_OWN,    FRAC_Z2,      0 },   // [complex] map, not an escape kernel
+    [MODE_BUDDHABROT]   = { "buddhabrot",   KIND_OWN,    FRAC_Z2,      0 },   // orbit density, see buddha.h
+    [MODE_NEBULABROT]   = { "nebulabrot",   KIND_OWN,    FRAC_Z2,      0 },
+    [MODE_LYAPUNOV]     = { "lyapunov",     KIND_OWN,    FRAC_LYAPUNOV, 0 },  // (a,b) plane, lyapunov.h
+    [MODE_RAYMARCH]     = { "raymarch",     KIND_OWN,    FRAC_Z2,      0 },   // [raymarch] sdf, not a plane view
+    [MODE_LIFE]         = { "life",         KIND_SIM,    FRAC_Z2,      0 },   // [sim] grids, see sim.h
+    [MODE_GRAYSCOTT]    = { "grayscott",    KIND_SIM,    FRAC_Z2,      0 },
+    [MODE_HEAT]         = { "heat",         KIND_SIM,    FRAC_Z2,      0 },
+};
+#define MODE_COUNT (int)(sizeof(MODE_INFO)/sizeof(MODE_INFO[0]))
+static int mode_escape(ModeType m){ return MODE_INFO[m].kind==KIND_ESCAPE; }
+static int mode_sim(ModeType m){ return MODE_INFO[m].kind==KIND_SIM; }
+
+/* sub-cell output: sx x sy samples per terminal cell, packed into one glyph */
+typedef enum { SUBCELL_OFF=0, SUBCELL_HALF, SUBCELL_BRAILLE, SUBCELL_SHAPE } SubcellMode;
+static const struct { const char *name; int sx, sy; } SUBCELL_INFO[] = {
+    [SUBCELL_OFF]     = { "off",     1, 1 },
+    [SUBCELL_HALF]    = { "half",    1, 2 },   // upper half block, fg = top, bg = bottom
+    [SUBCELL_BRAILLE] = { "braille", 2, 4 },   // one dot per sample
+    [SUBCELL_SHAPE]   = { "shape",   SHAPE_COLS, SHAPE_ROWS },   // charset glyph nearest the sample pattern
+};
+#define SUBCELL_COUNT (int)(sizeof(SUBCELL_INFO)/sizeof(SUBCELL_INFO[0]))
+
+static const char *const DITHER_NAMES[] = {
+    [DITHER_OFF]="off", [DITHER_BAYER]="bayer", [DITHER_BLUE]="bluenoise", [DITHER_FS]="fs", [DITHER_SERPENTINE]="serpentine",
+};
+#define DITHER_COUNT (int)(sizeof(DITHER_NAMES)/sizeof(DITHER_NAMES[0]))
+
+/* expr cells evaluated per frame: all, alternate rows, a checkerboard or 1
+   of every temporal_n, the pattern shifting by one each frame */
+typedef enum { TEMPORAL_OFF=0, TEMPORAL_ROWS, TEMPORAL_CHECKER, TEMPORAL_STRIDE } TemporalMode;
+
+/* how a layer's cell lands on the layers below it; a blank cell is a space
+   without background color */
+typedef enum { BLEND_OVER=0, BLEND_UNDER, BLEND_MASK, BLEND_CUT } BlendMode;
+static const char *const BLEND_NAMES[] = { "over", "under", "mask", "cut" };
+#define BLEND_COUNT (int)(sizeof(BLEND_NAMES)/sizeof(BLEND_NAMES[0]))
+#define LAYER_MAX 8
 
 typedef enum { INFO_ALL=0, INFO_NONE=1, INFO_VALUES=2 } InfoMode;
 
@@ -94,6 +158,14 @@ typedef struct {
     int transparent_ws;   // don't color spaces
     long duration_ms;     // -1 for infinite
     int width, height;
+    int threads;          // render threads (0 = one per CPU)
+    int supersample;      // extra samples per edge cell (expr, fractals); 0 = off
+    int subcell;          // SUBCELL_*: several samples packed into each glyph
+    int dither;           // DITHER_*: before the glyph / palette step lookup
+    int temporal;         // TEMPORAL_*: expr evaluates a rotating subset of cells
+    int temporal_n;       // stride: 1 in n cells per frame
+    int temporal_age;     // frames a cell may be reused before it is evaluated anyway
+    int field_mb;         // expr: memory for the per-cell values of time-invariant subexpressions
 
     // charset (fallback if no baked char palette chosen)
     char charset[256];
@@ -110,17 +182,59 @@ typedef struct {
     // fractal
     int max_iter;
     double cx, cy;
+    Mp hcx, hcy;             // center_x/y with every digit the cfg gave (deep zoom)
     double scale;
     double j_re, j_im;
+    int power;               // multibrot exponent
+    int julia_seed;          // seed multibrot/burning_ship/tricorn julia-style with c
+    FracPrec frac_prec;      // auto | float | double | dd | perturb
+    int frac_series;         // perturbation: series approximation skip
+    FracMethod frac_method;  // brute | subdiv (Mariani-Silver)
+    int frac_validate;       // also brute-force each frame and count mismatches
+    int frac_progressive;    // 1/4 -> 1/2 -> full resolution after a view change
+    int frac_smooth;         // continuous escape counts instead of whole iterations
+    int frac_equalize;       // spread escape counts over the ramp by histogram rank
+    int frac_budget;         // iterations per frame once max_iter exceeds it (0 = off)
+    int frac_cache_mb;       // memory cap of the finished-viewport LRU (0 = off)
+    int buddha_samples;      // buddhabrot/nebulabrot: orbits added per frame
+    Path path;               // scripted camera keyframes ([path])
+
+    // complex_iter: z -> map(z) from z0, seen through the [fractal] view
+    char cx_map[512];
+    char cx_z0[256];
+    double cx_bailout, cx_converge;
+
+    // lyapunov: r runs through this A/B sequence
+    unsigned lyap_seq;
+    int lyap_seq_len;
+
+    // raymarch: distance function in p.x/p.y/p.z/t plus camera and budgets
+    char ray_sdf[1024];
+    RayCam ray;
+
+    // life/grayscott/heat: grid rules, steps per second and grid multiple
+    SimParams sim;
+    double sim_rate;
+    int sim_max_steps;       // per frame; a slow frame drops the rest
+    int sim_scale;
 
     // background fill glyph (UTF-8)
     char background_utf8[8]; // " " (space) means no fill; UTF-8 single-cell recommended
+
+    // [layer.N]: the base config's layers; a layer's own config holds its update rate,
+    // blend rule and palette names, the rest comes from the base plus [layer.N.section]
+    unsigned layer_mask;     // bit n: [layer.n] is present
+    double layer_rate;       // redraws per second; 0 = once, <0 = every frame
+    int layer_blend;         // BLEND_*
+    char layer_char[64], layer_color[64];   // palette names ("" = the base's)
 } Config;
 
 static void set_defaults(Config *c){
     memset(c,0,sizeof(*c));
     c->fps = 30;
     c->use_color = 1;
+    c->temporal_age = 8;
+    c->field_mb = 16;
     c->color_func = 0;
     c->transparent_ws = 1;
     c->duration_ms = -1;
@@ -131,9 +245,35 @@ static void set_defaults(Config *c){
     strcpy(c->expr_color, "128+127*sin(t+3.0*r)");
     c->max_iter = 200;
     c->cx = -0.5; c->cy = 0.0;
+    mp_from_double(&c->hcx, c->cx); mp_from_double(&c->hcy, c->cy);
     c->scale = 2.8;
     c->j_re = -0.8; c->j_im = 0.156;
+    c->power = 3;
+    c->frac_progressive = 1;
+    c->frac_smooth = 1;
+    c->frac_equalize = 1;
+    c->frac_prec = FRAC_PREC_AUTO;
+    c->frac_series = 1;
+    c->frac_budget = 1000;
+    c->frac_cache_mb = 32;
+    c->buddha_samples = 20000;
+    c->path.lookahead = 8;
+    strcpy(c->cx_map, "z - (z^3 - 1)/(3*z^2)");   // newton's method on z^3 = 1
+    strcpy(c->cx_z0, "p");
+    c->cx_bailout = 1e6;
+    c->cx_converge = 1e-6;
+    lyap_parse_seq("AB", &c->lyap_seq, &c->lyap_seq_len);
+    strcpy(c->ray_sdf, "smoothmin(length(p.x,p.y-0.3*sin(t),p.z)-1, length(length(p.x,p.z)-1.6,p.y)-0.3, 0.4)");
+    c->ray = (RayCam){ .pos={ 0,1.5,-4 }, .target={ 0,0,0 }, .fov=50, .spin=0.3,
+                       .light={ -0.5,0.8,-0.6 }, .steps=96, .eps=1e-3, .max_dist=20 };
+    c->sim = (SimParams){ .density=0.3, .feed=0.055, .kill=0.062, .du=1.0, .dv=0.5,
+                          .alpha=0.2, .cool=0.002, .seed=1 };
+    sim_parse_rule("B3/S23", &c->sim.birth, &c->sim.survive);
+    c->sim_rate = 30;
+    c->sim_max_steps = 64;
+    c->sim_scale = 1;
     strcpy(c->background_utf8, " "); // default edges-only
+    c->layer_rate = -1;
 }
 
 // --------------- baked presets & palettes (generated headers) ---------------
@@ -158,9 +298,19 @@ static int strieq(const char *a,const char *b){
     return *a==0 && *b==0;
 }
 
+// "x y z" or "x,y,z"; leaves v alone unless all three parse
+static void parse_vec3(const char *s, double *v){
+    double x,y,z;
+    if(sscanf(s," %lf%*[ ,]%lf%*[ ,]%lf",&x,&y,&z)==3){ v[0]=x; v[1]=y; v[2]=z; }
+}
+
 // ----------------------------- INI helpers ---------------------------------
-static void parse_ini(Config *c, const char *text){
+/* layer 0 reads the base sections and notes which [layer.N] exist; layer N
+   reads only [layer.N] (its own keys, [mode] type and [render] keys) and
+   [layer.N.section], each over what c already holds */
+static void parse_ini(Config *c, const char *text, int layer){
     char sect[64]="";
+    int own_keys=0;   // a layer's first path key drops the ones it inherited
     const char *p=text;
     while(*p){
         const char *line=p;
@@ -187,7 +337,25 @@ static void parse_ini(Config *c, const char *text){
         while(*val==' '||*val=='\t') val++;
         if(*val=='\"' || *val=='\''){ char q=*val; size_t vlen=strlen(val); if(vlen>=2 && val[vlen-1]==q){ val[vlen-1]=0; val++; } }
 
-        if(strieq(sect,"render")){
+        const char *sp=sect;
+        char pre[7]; snprintf(pre,sizeof(pre),"%s",sect);
+        if(strieq(pre,"layer.")){
+            char *e; long n=strtol(sect+6,&e,10);
+            if(n<1 || n>LAYER_MAX) continue;
+            if(!layer){ c->layer_mask |= 1u<<n; continue; }
+            if(n!=layer) continue;
+            if(*e=='.') sp=e+1;
+            else if(strieq(key,"rate")){ c->layer_rate = atof(val); continue; }
+            else if(strieq(key,"blend")){
+                for(int m=0;m<BLEND_COUNT;m++) if(strieq(val,BLEND_NAMES[m])) c->layer_blend=m;
+                continue;
+            }
+            else if(strieq(key,"char")){ snprintf(c->layer_char,sizeof(c->layer_char),"%s",val); continue; }
+            else if(strieq(key,"color")){ snprintf(c->layer_color,sizeof(c->layer_color),"%s",val); continue; }
+            else sp = (strieq(key,"type")||strieq(key,"mode")) ? "mode" : "render";
+        } else if(layer) continue;
+
+        if(strieq(sp,"render")){
             if(strieq(key,"fps")) c->fps = atoi(val);
             else if(strieq(key,"use_color")) c->use_color = atoi(val);
             else if(strieq(key,"color_func")) c->color_func = atoi(val);
@@ -195,27 +363,109 @@ static void parse_ini(Config *c, const char *text){
             else if(strieq(key,"duration")) c->duration_ms = (long)(atof(val)*1000.0);
             else if(strieq(key,"width")) c->width = atoi(val);
             else if(strieq(key,"height")) c->height = atoi(val);
+            else if(strieq(key,"threads")) c->threads = atoi(val);
+            else if(strieq(key,"supersample")) c->supersample = atoi(val);
+            else if(strieq(key,"subcell")){
+                for(int m=0;m<SUBCELL_COUNT;m++) if(strieq(val,SUBCELL_INFO[m].name)) c->subcell=m;
+            }
+            else if(strieq(key,"temporal")){
+                if(strieq(val,"rows")) c->temporal=TEMPORAL_ROWS;
+                else if(strieq(val,"checker")) c->temporal=TEMPORAL_CHECKER;
+                else if(atoi(val)>1){ c->temporal=TEMPORAL_STRIDE; c->temporal_n=atoi(val); }
+                else c->temporal=TEMPORAL_OFF;
+            }
+            else if(strieq(key,"temporal_age")) c->temporal_age = atoi(val);
+            else if(strieq(key,"field_mb")) c->field_mb = atoi(val);
+            else if(strieq(key,"dither")){
+                for(int m=0;m<DITHER_COUNT;m++) if(strieq(val,DITHER_NAMES[m])) c->dither=m;
+            }
             else if(strieq(key,"charset")) strncpy(c->charset,val,sizeof(c->charset)-1);
             else if(strieq(key,"background")||strieq(key,"background_char")){
                 strncpy(c->background_utf8,val,sizeof(c->background_utf8)-1);
                 c->background_utf8[sizeof(c->background_utf8)-1]=0;
             }
-        } else if(strieq(sect,"mode")){
-            if(strieq(key,"type")){
-                if(strieq(val,"expr")) c->mode=MODE_EXPR;
-                else if(strieq(val,"mandelbrot")) c->mode=MODE_MANDELBROT;
-                else if(strieq(val,"julia")) c->mode=MODE_JULIA;
+        } else if(strieq(sp,"mode")){
+            if(strieq(key,"type")||strieq(key,"mode")){
+                for(int m=0;m<MODE_COUNT;m++) if(strieq(val,MODE_INFO[m].name)) c->mode=(ModeType)m;
+                if(strieq(val,"burningship")||strieq(val,"ship")) c->mode=MODE_BURNING_SHIP;
             }
-        } else if(strieq(sect,"expr")){
+        } else if(strieq(sp,"expr")){
             if(strieq(key,"value")) strncpy(c->expr_value,val,sizeof(c->expr_value)-1);
             else if(strieq(key,"color")) strncpy(c->expr_color,val,sizeof(c->expr_color)-1);
-        } else if(strieq(sect,"fractal")){
-            if(strieq(key,"max_iter")) c->max_iter = atoi(val);
-            else if(strieq(key,"center_x")) c->cx = atof(val);
-            else if(strieq(key,"center_y")) c->cy = atof(val);
+        } else if(strieq(sp,"fractal")){
+            if(strieq(key,"max_iter")) c->max_iter = (int)clamp_long(atol(val),1,FRAC_MAX_ITER);
+            else if(strieq(key,"center_x")){ c->cx = atof(val); if(!mp_from_str(&c->hcx,val)) mp_from_double(&c->hcx,c->cx); }
+            else if(strieq(key,"center_y")){ c->cy = atof(val); if(!mp_from_str(&c->hcy,val)) mp_from_double(&c->hcy,c->cy); }
             else if(strieq(key,"scale")) c->scale = atof(val);
             else if(strieq(key,"c_re")) c->j_re = atof(val);
             else if(strieq(key,"c_im")) c->j_im = atof(val);
+            else if(strieq(key,"power")) c->power = (int)clamp_long(atoi(val),2,FRAC_MAX_POWER);
+            else if(strieq(key,"julia")) c->julia_seed = atoi(val);
+            else if(strieq(key,"method")){
+                if(strieq(val,"brute")) c->frac_method=FRAC_BRUTE;
+                else if(strieq(val,"subdiv")||strieq(val,"mariani")) c->frac_method=FRAC_SUBDIV;
+            }
+            else if(strieq(key,"validate")) c->frac_validate = atoi(val);
+            else if(strieq(key,"progressive")) c->frac_progressive = atoi(val);
+            else if(strieq(key,"smooth")) c->frac_smooth = atoi(val);
+            else if(strieq(key,"equalize")) c->frac_equalize = atoi(val);
+            else if(strieq(key,"precision")){
+                if(strieq(val,"auto")) c->frac_prec=FRAC_PREC_AUTO;
+                else if(strieq(val,"float")||strieq(val,"f32")) c->frac_prec=FRAC_PREC_FLOAT;
+                else if(strieq(val,"double")||strieq(val,"f64")) c->frac_prec=FRAC_PREC_DOUBLE;
+                else if(strieq(val,"dd")||strieq(val,"double-double")) c->frac_prec=FRAC_PREC_DD;
+                else if(strieq(val,"perturb")||strieq(val,"deep")) c->frac_prec=FRAC_PREC_PERTURB;
+            }
+            else if(strieq(key,"series")) c->frac_series = atoi(val);
+            else if(strieq(key,"iter_budget")) c->frac_budget = atoi(val);
+            else if(strieq(key,"cache_mb")) c->frac_cache_mb = atoi(val);
+            else if(strieq(key,"samples")) c->buddha_samples = atoi(val);
+        } else if(strieq(sp,"complex")){
+            if(strieq(key,"map")) strncpy(c->cx_map,val,sizeof(c->cx_map)-1);
+            else if(strieq(key,"z0")) strncpy(c->cx_z0,val,sizeof(c->cx_z0)-1);
+            else if(strieq(key,"bailout")) c->cx_bailout = atof(val);
+            else if(strieq(key,"converge")) c->cx_converge = atof(val);
+        } else if(strieq(sp,"lyapunov")){
+            if(strieq(key,"sequence")) lyap_parse_seq(val,&c->lyap_seq,&c->lyap_seq_len);
+        } else if(strieq(sp,"raymarch")){
+            if(strieq(key,"sdf")) strncpy(c->ray_sdf,val,sizeof(c->ray_sdf)-1);
+            else if(strieq(key,"camera")) parse_vec3(val,c->ray.pos);
+            else if(strieq(key,"target")) parse_vec3(val,c->ray.target);
+            else if(strieq(key,"light")) parse_vec3(val,c->ray.light);
+            else if(strieq(key,"fov")) c->ray.fov = atof(val);
+            else if(strieq(key,"spin")) c->ray.spin = atof(val);
+            else if(strieq(key,"steps")) c->ray.steps = atoi(val);
+            else if(strieq(key,"epsilon")) c->ray.eps = atof(val);
+            else if(strieq(key,"max_dist")) c->ray.max_dist = atof(val);
+        } else if(strieq(sp,"sim")){
+            if(strieq(key,"rule")) sim_parse_rule(val,&c->sim.birth,&c->sim.survive);
+            else if(strieq(key,"density")) c->sim.density = atof(val);
+            else if(strieq(key,"feed")) c->sim.feed = atof(val);
+            else if(strieq(key,"kill")) c->sim.kill = atof(val);
+            else if(strieq(key,"du")) c->sim.du = atof(val);
+            else if(strieq(key,"dv")) c->sim.dv = atof(val);
+            else if(strieq(key,"alpha")) c->sim.alpha = clamp(atof(val),0.0,SIM_HEAT_MAX_ALPHA);
+            else if(strieq(key,"cool")) c->sim.cool = atof(val);
+            else if(strieq(key,"seed")) c->sim.seed = (unsigned)strtoul(val,NULL,10);
+            else if(strieq(key,"rate")) c->sim_rate = atof(val);
+            else if(strieq(key,"max_steps")) c->sim_max_steps = atoi(val);
+            else if(strieq(key,"scale")) c->sim_scale = atoi(val);
+        } else if(strieq(sp,"path")){
+            if(strieq(key,"key")){
+                // omitted trailing fields repeat the previous key ([fractal] for the first)
+                if(layer && !own_keys){ c->path.n=0; own_keys=1; }
+                PathKey prev;
+                if(c->path.n) prev = c->path.key[c->path.n-1];
+                else {
+                    memset(&prev,0,sizeof(prev));
+                    prev.cx=c->hcx; prev.cy=c->hcy; prev.scale=c->scale;
+                    prev.j_re=c->j_re; prev.j_im=c->j_im; prev.max_iter=c->max_iter;
+                }
+                path_add_key(&c->path,val,&prev);
+            }
+            else if(strieq(key,"interp")) c->path.smooth = strieq(val,"smooth");
+            else if(strieq(key,"loop")) c->path.loop = atoi(val);
+            else if(strieq(key,"lookahead")) c->path.lookahead = atoi(val);
         }
     }
 }
@@ -337,13 +587,15 @@ static double parse_primary(Parser *p, const Vars *vars){
     if(match(p,"n")) return vars->n;
 
     const char *save=p->s; char name[16]={0}; int k=0;
-    while((*p->s>='a'&&*p->s<='z')||(*p->s>='A'&&*p->s<='Z')){ if(k<15) name[k++]=*p->s; p->s++; }
+    while((*p->s>='a'&&*p->s<='z')||(*p->s>='A'&&*p->s<='Z')||(k>0&&*p->s>='0'&&*p->s<='9')){ if(k<15) name[k++]=*p->s; p->s++; }
     name[k]=0;
     if(k>0){
         for(int q=0;q<k;q++) if(name[q]>='A'&&name[q]<='Z') name[q]+=32;
         if(accept(p,'(')){
-            double a = parse_expr(p,vars), b=0;
+            double a = parse_expr(p,vars), b=0, c=0, d=0;
             if(accept(p,',')) b=parse_expr(p,vars);
+            if(accept(p,',')) c=parse_expr(p,vars);
+            if(accept(p,',')) d=parse_expr(p,vars);
             accept(p,')');
             if(strcmp(name,"sin")==0) return sin(a);
             if(strcmp(name,"cos")==0) return cos(a);
@@ -361,8 +613,12 @@ static double parse_primary(Parser *p, const Vars *vars){
             if(strcmp(name,"max")==0) return (a>b)?a:b;
             if(strcmp(name,"pow")==0) return pow(a,b);
             if(strcmp(name,"mod")==0) return fmod(a,b==0?1:b);
+            if(strcmp(name,"noise2")==0) return noise2(a,b);
+            if(strcmp(name,"noise3")==0) return noise3(a,b,c);
+            if(strcmp(name,"fbm")==0) return noise_fbm(a,b,c,d);
             return NAN;
-        } else {
+        } else if(strcmp(name,"pi")==0) return 3.14159265358979323846;   // as rexpr's
+        else {
             p->s = save;
         }
     }
@@ -405,6 +661,8 @@ typedef struct {
     Glyph g[256];
     int count;
     char name[64];
+    ShapeDesc shape[256];          // coverage descriptors, from shape= or built in
+    unsigned char shape_known[256];
 } ActiveCharset;
 
 // split continuous string " ▁▂▃…" into glyphs
@@ -453,7 +711,7 @@ static void cs_from_csv(ActiveCharset *cs, const char *csv, const char *name){
     }
 }
 
-static void emit_glyph(const Glyph *g){ ssize_t w=write(STDOUT_FILENO,g->glyph,g->glen); (void)w; }
+static void emit_glyph(const Glyph *g){ term_write(g->glyph,g->glen); }
 
 // ----------------------------- baked palettes hooks ------------------------
 static int g_charpal_idx = -1;        // -1 => fallback from config string
@@ -464,7 +722,7 @@ static int g_colorpal_idx = -1;       // -1 => legacy color expr
 // extract char palette content
 static int extract_value_any(const char*, const char*, char*, size_t); // fwd (already above)
 static void parse_char_palette_text(const char *text, ActiveCharset *cs){
-    char name[64]={0}, glyphs[1024]={0}, charset[1024]={0};
+    char name[64]={0}, glyphs[1024]={0}, charset[1024]={0}, shape[2048]={0};
     extract_value_any(text,"name",name,sizeof(name));
     if(extract_value_any(text,"glyphs",glyphs,sizeof(glyphs))){
         cs_from_csv(cs,glyphs,name[0]?name:NULL);
@@ -473,6 +731,7 @@ static void parse_char_palette_text(const char *text, ActiveCharset *cs){
     }else{
         cs_from_string(cs," .:-=+*#%@", "fallback");
     }
+    if(extract_value_any(text,"shape",shape,sizeof(shape))) shape_parse(shape,cs->shape,cs->shape_known,cs->count);
 }
 
 // color palette
@@ -546,6 +805,28 @@ static void bg_cycle_next(BackgroundState *bgs){
 }
 
 // ----------------------------- rendering -----------------------------------
+/* one output cell: glyph after background substitution, 256-color codes or -1 */
+typedef struct {
+    const Glyph *g;
+    int          ci;
+    int          bg;   // background, sub-cell modes only
+} Cell;
+
+/* sub-cell glyphs by sample bitmask: half blocks (bit 0 top, bit 1 bottom)
+   and the 256 braille patterns, built once at startup */
+static Glyph g_half[4];
+static Glyph g_braille[256];
+static const unsigned char BRAILLE_BIT[4][2] = { { 0x01,0x08 }, { 0x02,0x10 }, { 0x04,0x20 }, { 0x40,0x80 } };
+
+static void subcell_tables_init(void){
+    static const char *HALF[4] = { " ", "\xe2\x96\x80", "\xe2\x96\x84", "\xe2\x96\x88" };   // ' ' ▀ ▄ █
+    for(int m=0;m<4;m++) glyph_from_utf8(&g_half[m],HALF[m]);
+    for(int m=0;m<256;m++){   // U+2800 + m
+        char u[4] = { (char)0xE2, (char)(0xA0 | m>>6), (char)(0x80 | (m & 0x3F)), 0 };
+        glyph_from_utf8(&g_braille[m],u);
+    }
+}
+
 static const char *FALLBACK_CHARSETS[] = {
     " .:-=+*#%@",
     " .'`^\",:;Il!i><~+_-?][}{1)(|\\/*tfjrxnuvczXYUJCLQ0OZmwqpdbkhao*#MW&8%B@$",
@@ -553,7 +834,25 @@ static const char *FALLBACK_CHARSETS[] = {
     " ▁▂▃▄▅▆▇█",
 };
 
+#define EXPR_NVARS  8
+#define EXPR_FIELDS (RX_MAX_VARS-EXPR_NVARS)
+
+/* an expression compiled for one sample grid. its subexpressions that don't
+   read t are fields: evaluated into a plane of W*H values when the grid or
+   the source changes, then read back each frame as extra variables */
 typedef struct {
+    RxProg  prog;
+    RxProg  whole;               // prog before hoisting, for samples off the grid
+    RxProg  field[EXPR_FIELDS];
+    int     nfields, ok;
+    char    src[1024];           // what prog came from
+    int     W, H, sx, sy, maxf;
+    double  n;                   // the n variable, fixed for the plan
+    double *data;                // nfields planes
+    size_t  cap;
+} ExprPlan;
+
+typedef struct App {
     Config        cfg;
     int           tw, th;
     double        t0;
@@ -580,14 +879,112 @@ typedef struct {
     int           pending_brace;  // awaiting brace type after ^P
 
     ActiveCharset acs;
+    ShapeMap      shape_map;      // nearest-glyph table for acs, subcell=shape
     ActiveColor   cur_col;
     int           cached_col_idx;
     int           cur_preset_idx;
 
     BackgroundState bg;
+
+    // cell grid shared by all renderers, plus fractal iteration buffers
+    Cell         *cells;
+    int          *iters;
+    int          *iters_ref;      // brute-force reference for validate=1
+    size_t        grid_cap;
+    long          frac_computed;  // cells actually iterated last frame
+    long          frac_mismatch;  // last frame's mismatches vs brute force
+    long          frac_checked_frames;
+    long          frac_bad_frames;
+    FracView      frac_view;      // view the iteration buffer belongs to
+    int           frac_step;      // finest pass completed for frac_view (0 = none)
+    FracRef       frac_ref;       // perturbation reference orbit for frac_view
+    FracOrbit     frac_orbit;     // per-cell orbits when max_iter is spread over frames
+    int           frac_orbit_on;  // frac_orbit belongs to frac_view
+    FracCache     frac_cache;     // finished iteration buffers of recent views
+    FracEq        frac_eq;        // equalization of iters, rebuilt when they change
+    int           frac_eq_valid;
+    double       *jz_re, *jz_im;  // julia: where each cell's orbit ended, for the color expression
+    size_t        jz_cap;
+    int           jz_valid;
+
+    // supersampling: edge cells, their colors and extra samples
+    unsigned char*aa_mark;
+    int          *aa_ci;
+    int          *aa_samples;
+    size_t        aa_cap, aa_samples_cap;
+    int           aa_valid;       // fractal: levels hold the averaged frame of frac_view
+    int           aa_glyphs;      // charset size the edges were found with
+    int           aa_steps, aa_eq;// palette steps (0 = none) and equalize it was averaged with
+
+    // per-cell values, colors and dithered glyph / palette steps for emit_values
+    float        *qv;
+    int          *qci;
+    unsigned char*qg, *qc;
+    size_t        q_cap;
+    DitherBuf     dither;
+
+    // temporal expr: values and colors kept from earlier frames, frames since each was evaluated
+    float        *tmp_v;
+    int          *tmp_ci;
+    unsigned char*tmp_age;
+    size_t        tmp_cap;
+    int           tmp_valid, tmp_w, tmp_h, tmp_color;
+    unsigned      tmp_frame;
+    char          tmp_src[2048];  // value and color expressions they came from
+
+    // expr: [expr] value and the color / palette index compiled for batched sampling
+    ExprPlan      expr_plan, color_plan;
+    int           path_on;        // [path] is driving the view
+    int           path_frame;     // path frame on screen
+    double        path_t;
+    PathAhead     ahead;          // prerenders the frames after path_frame
+    Pool         *pool;           // render threads (NULL = serial)
+
+    // complex_iter: compiled map and the per-cell results of cx_view
+    CxMap         cx;
+    char          cx_src[800];    // map + z0 the programs were compiled from
+    char          cx_err[128];    // compile error, shown in the HUD
+    int           cx_ok;
+    double       *cx_zr, *cx_zi;  // where each orbit ended
+    unsigned char*cx_state;       // CX_MAXED / CX_ESCAPED / CX_CONVERGED
+    int          *cx_basin;
+    size_t        cx_cap;
+    int           cx_roots;
+    FracView      cx_view;        // view the buffers belong to
+    double        cx_t;           // t they were computed at (maps using t only)
+    int           cx_valid;
+
+    Buddha        buddha;         // orbit density of the current buddhabrot view
+    float        *levels;         // its per-channel display levels (raymarch: shade)
+    size_t        levels_cap;
+
+    // raymarch: compiled sdf and what the shade buffer was rendered for
+    RxProg        ray_sdf;
+    char          ray_src[1024];
+    char          ray_err[128];
+    int           ray_ok;
+    RayCam        ray_cam;
+    int           ray_w, ray_h;
+    double        ray_t;
+    int           ray_valid;
+
+    // life/grayscott/heat: the running grid and the clock it is stepped by
+    Sim           sim;
+    double        sim_t0;         // t of sim step 0, moved up when frames drop steps
+    int           sim_frame_steps;// steps run for the frame on screen
+
+    // [layer.N]: each layer is an App of its own, its grid kept between redraws
+    struct App   *layer[LAYER_MAX];
+    int           nlayers;
+    int           is_layer;       // renderers leave the grid for compositing
+    int           own_cs, own_col;// layer: palettes of its own, else the base's
+    int           drawn_w, drawn_h; // size of the grid the last frame left in cells
+    double        layer_t;        // layer: t of its last redraw
 } App;
 
 static void app_pick_charset(App *a){
+    a->shape_map.valid=0;
+    a->tmp_valid=0;
     if(g_charpal_idx >= 0 && (size_t)g_charpal_idx < g_char_pals_count){
         parse_char_palette_text(g_char_pals[g_charpal_idx].text,&a->acs);
         if(!a->acs.name[0]) snprintf(a->acs.name,sizeof(a->acs.name),"%s", g_char_pals[g_charpal_idx].name);
@@ -601,14 +998,18 @@ static void app_init_background(App *a){
     bg_from_config(&a->bg, a->cfg.background_utf8);
 }
 
+// --bench runs with no tty: the grid size is fixed and no input comes
+static int g_headless, g_headless_w, g_headless_h;
+
 static void app_query_size(App *a){
+    if(g_headless){ a->tw=g_headless_w; a->th=g_headless_h; return; }
     int w,h; get_tty_size(&w,&h);
     if(a->cfg.width>0) w = a->cfg.width;
     if(a->cfg.height>0) h = a->cfg.height;
     a->tw=w; a->th=h;
 }
 
-static void append_str(const char *s){ ssize_t w=write(STDOUT_FILENO,s,strlen(s)); (void)w; }
+static void append_str(const char *s){ term_write(s,strlen(s)); }
 
 /* --- editor helpers ----------------------------------------------------- */
 static const double EDIT_STEPS[] = {0.01,0.1,1.0,10.0};
@@ -919,7 +1320,7 @@ static void cancel_edit_text(App *a){
 
 static void format_info_strings(App *a, char *line1, size_t n1, char *line2, size_t n2){
     if(a->run_mode==RUNMODE_PLAYER){
-        const char *m = (a->cfg.mode==MODE_EXPR)?"expr":(a->cfg.mode==MODE_MANDELBROT)?"mandelbrot":"julia";
+        const char *m = MODE_INFO[a->cfg.mode].name;
         const char *colname = a->cur_col.valid ? a->cur_col.name : "expr";
         char bgdisp[16];
         snprintf(bgdisp,sizeof(bgdisp),"%s", a->bg.bg.glyph[0] ? a->bg.bg.glyph : " ");
@@ -935,6 +1336,66 @@ static void format_info_strings(App *a, char *line1, size_t n1, char *line2, siz
                 COL_KEY, "n", COL_RESET, COL_NAME, a->acs.name[0]?a->acs.name:"(unnamed)", COL_RESET,
                 COL_KEY, "w", COL_RESET, COL_VALUE, bgshow, COL_RESET,
                 COL_KEY, "W", COL_RESET, COL_NAME, COL_RESET, COL_STATE, a->cfg.transparent_ws?"transp":"color", COL_RESET);
+            if(a->nlayers){
+                size_t L=strlen(line1);
+                if(L<n1) snprintf(line1+L,n1-L," [%slayers%s:%s%d%s] [%sthreads%s:%s%d%s]" COL_RESET,
+                    COL_NAME, COL_RESET, COL_VALUE, a->nlayers, COL_RESET, COL_NAME, COL_RESET, COL_VALUE, pool_threads(a->pool), COL_RESET);
+            }else if(a->cfg.mode==MODE_BUDDHABROT || a->cfg.mode==MODE_NEBULABROT){
+                size_t L=strlen(line1);
+                if(L<n1) snprintf(line1+L,n1-L," [%ssamples%s:%s%ldk%s] [%sthreads%s:%s%d%s]" COL_RESET,
+                    COL_NAME, COL_RESET, COL_VALUE, a->buddha.samples/1000, COL_RESET, COL_NAME, COL_RESET, COL_VALUE, pool_threads(a->pool), COL_RESET);
+            }else if(a->cfg.mode==MODE_LYAPUNOV){
+                char seq[LYAP_MAX_SEQ+1]; lyap_seq_str(a->cfg.lyap_seq,a->cfg.lyap_seq_len,seq);
+                size_t L=strlen(line1);
+                if(L<n1) snprintf(line1+L,n1-L," [%sseq%s:%s%s%s] [%scache%s:%s%ld/%ld%s]" COL_RESET,
+                    COL_NAME, COL_RESET, COL_VALUE, seq, COL_RESET, COL_NAME, COL_RESET, COL_VALUE, a->frac_cache.hits, a->frac_cache.misses, COL_RESET);
+            }else if(a->cfg.mode==MODE_RAYMARCH){
+                size_t L=strlen(line1);
+                if(L<n1 && !a->ray_ok) snprintf(line1+L,n1-L," [%serror%s:%s%s%s]" COL_RESET, COL_NAME, COL_RESET, COL_VALUE, a->ray_err, COL_RESET);
+                else if(L<n1) snprintf(line1+L,n1-L," [%ssteps%s:%s%d%s %seps%s:%s%g%s] [%sthreads%s:%s%d%s]" COL_RESET,
+                    COL_NAME, COL_RESET, COL_VALUE, a->cfg.ray.steps, COL_RESET, COL_NAME, COL_RESET, COL_VALUE, a->cfg.ray.eps, COL_RESET,
+                    COL_NAME, COL_RESET, COL_VALUE, pool_threads(a->pool), COL_RESET);
+            }else if(mode_sim(a->cfg.mode)){
+                char rule[24]="";
+                if(a->cfg.mode==MODE_LIFE){
+                    char r[20]; sim_rule_str(a->cfg.sim.birth,a->cfg.sim.survive,r,sizeof(r));
+                    snprintf(rule,sizeof(rule),"%s ",r);
+                }
+                size_t L=strlen(line1);
+                if(L<n1) snprintf(line1+L,n1-L," [%s%sgen%s:%s%ld%s +%d] [%sgrid%s:%s%dx%d%s] [%sthreads%s:%s%d%s]" COL_RESET,
+                    COL_NAME, rule, COL_RESET, COL_VALUE, a->sim.steps, COL_RESET, a->sim_frame_steps,
+                    COL_NAME, COL_RESET, COL_VALUE, a->sim.w, a->sim.h, COL_RESET, COL_NAME, COL_RESET, COL_VALUE, pool_threads(a->pool), COL_RESET);
+            }else if(a->cfg.mode==MODE_COMPLEX){
+                size_t L=strlen(line1);
+                if(L<n1 && !a->cx_ok) snprintf(line1+L,n1-L," [%serror%s:%s%s%s]" COL_RESET, COL_NAME, COL_RESET, COL_VALUE, a->cx_err, COL_RESET);
+                else if(L<n1) snprintf(line1+L,n1-L," [%sroots%s:%s%d%s] [%sthreads%s:%s%d%s]" COL_RESET,
+                    COL_NAME, COL_RESET, COL_VALUE, a->cx_roots, COL_RESET, COL_NAME, COL_RESET, COL_VALUE, pool_threads(a->pool), COL_RESET);
+            }else if(a->cfg.mode!=MODE_EXPR){
+                long cells = (long)a->frac_view.w * a->frac_view.h;
+                long pct = cells>0 ? a->frac_computed*100/cells : 0;
+                char diff[64]="";
+                if(a->cfg.frac_validate && a->cfg.frac_method!=FRAC_BRUTE)
+                    snprintf(diff,sizeof(diff)," %sdiff%s:%s%ld%s", COL_NAME, COL_RESET, COL_VALUE, a->frac_mismatch, COL_RESET);
+                char pass[32]="";
+                if(a->frac_orbit_on && a->frac_step!=1)
+                    snprintf(pass,sizeof(pass)," it%d/%d",a->frac_orbit.iter,a->frac_view.max_iter);
+                else if(a->frac_step>1) snprintf(pass,sizeof(pass)," 1/%d",a->frac_step);
+                static const char *PREC_NAMES[] = { "auto", "f32", "f64", "dd", "perturb" };
+                char prec[64];
+                if(a->frac_view.prec==FRAC_PREC_PERTURB)
+                    snprintf(prec,sizeof(prec),"%sperturb%s:%ssa%d%s", COL_NAME, COL_RESET, COL_VALUE, a->frac_ref.skip, COL_RESET);
+                else snprintf(prec,sizeof(prec),"%s%s%s", COL_NAME, PREC_NAMES[a->frac_view.prec], COL_RESET);
+                char cache[96]="";
+                if(a->frac_cache.limit)
+                    snprintf(cache,sizeof(cache)," [%scache%s:%s%ld/%ld%s]", COL_NAME, COL_RESET, COL_VALUE, a->frac_cache.hits, a->frac_cache.misses, COL_RESET);
+                char path[96]="";
+                if(a->path_on)
+                    snprintf(path,sizeof(path)," [%spath%s:%s%.1f/%.1fs%s %sahead%s:%s%d%s]", COL_NAME, COL_RESET, COL_VALUE,
+                        a->path_t, path_length(&a->cfg.path), COL_RESET, COL_NAME, COL_RESET, COL_VALUE, path_ahead_ready(&a->ahead), COL_RESET);
+                size_t L=strlen(line1);
+                if(L<n1) snprintf(line1+L,n1-L," [%s%s%s:%s%ld%%%s%s%s] [%s]%s%s" COL_RESET,
+                    COL_NAME, a->frac_orbit_on?"orbit":a->cfg.frac_method==FRAC_SUBDIV?"subdiv":"brute", COL_RESET, COL_VALUE, pct, pass, COL_RESET, diff, prec, cache, path);
+            }
         }
         if(line2 && n2){
             snprintf(line2,n2,
@@ -1055,20 +1516,38 @@ static int print_wrapped(const char *line, int width, int row_start){
     term_move(row,1);
     while(*p){
         if(*p=='\x1b'){
-            const char *q=strchr(p,'m'); if(!q) break; ssize_t w1=write(STDOUT_FILENO,p,q-p+1); (void)w1; p=q+1; continue;
+            const char *q=strchr(p,'m'); if(!q) break; term_write(p,(size_t)(q-p+1)); p=q+1; continue;
         }
         if(col>=width){ col=0; row++; term_move(row,1); }
-        ssize_t w2=write(STDOUT_FILENO,p,1); (void)w2; p++; col++;
+        term_write(p,1); p++; col++;
     }
     return row - row_start + 1;
 }
 
+// the last closed frame: achieved rate, work-time percentiles, ms per stage, output
+static void format_stats_line(const App *a, char *out, size_t n){
+    static const char *const SHORT[STAGE_COUNT] = { "in", "eval", "iter", "enc", "wr", "sleep" };
+    const Stats *s = &g_stats;
+    size_t L = (size_t)snprintf(out,n,
+        COL_RESET "[%sfps%s:%s%.1f/%d%s] [%sp50%s:%s%.1f%s %sp99%s:%s%.1f%s ms] [",
+        COL_NAME, COL_RESET, COL_VALUE, s->fps, a->cfg.fps<=0?30:a->cfg.fps, COL_RESET,
+        COL_NAME, COL_RESET, COL_VALUE, s->p50*1e3, COL_RESET,
+        COL_NAME, COL_RESET, COL_VALUE, s->p99*1e3, COL_RESET);
+    for(int k=0;k<STAGE_COUNT && L<n;k++)
+        L += (size_t)snprintf(out+L,n-L,"%s%s%s%s:%s%.1f%s", k?" ":"", COL_NAME, SHORT[k], COL_RESET, COL_VALUE, s->last[k]*1e3, COL_RESET);
+    if(L<n) snprintf(out+L,n-L," ms] [%sout%s:%s%.1f%sKB/%s%llu%sw]" COL_RESET,
+        COL_NAME, COL_RESET, COL_VALUE, s->bytes/1024.0, COL_RESET, COL_VALUE, s->writes, COL_RESET);
+}
+
 static void update_info_rows(App *a){
     if(a->info_mode==INFO_NONE){ a->info_rows=0; return; }
     char l1[4096]; char l2[4096];
     format_info_strings(a,l1,sizeof(l1),l2,sizeof(l2));
     int lines = count_wrapped(l1,a->tw);
-    if(a->info_mode==INFO_ALL) lines += count_wrapped(l2,a->tw);
+    if(a->info_mode==INFO_ALL){
+        char l3[1024]; format_stats_line(a,l3,sizeof(l3));
+        lines += count_wrapped(l2,a->tw) + count_wrapped(l3,a->tw);
+    }
     a->info_rows = lines;
 }
 
@@ -1085,7 +1564,9 @@ static void draw_info_bar(App *a){
     int start = a->th - a->info_rows + 1;
     int l1 = print_wrapped(line1,a->tw,start);
     if(a->info_mode==INFO_ALL){
-        print_wrapped(line2,a->tw,start + l1);
+        int l2 = *line2 ? print_wrapped(line2,a->tw,start + l1) : 0;
+        char line3[1024]; format_stats_line(a,line3,sizeof(line3));
+        print_wrapped(line3,a->tw,start + l1 + l2);
     }
     prev_lines = a->info_rows;
 }
@@ -1109,7 +1590,7 @@ static inline int col_idx_from_value(const ActiveColor *ac, double v){
     return idx;
 }
 
-static int pixel_color_code(App *a, int i,int j,double x,double y,double t){
+static int pixel_color_code(const App *a, int i,int j,double x,double y,double t){
     if(!a->cfg.use_color) return -1;
     if(a->cur_col.valid && a->cur_col.count>0){
         Vars v = { .x=x,.y=y,.i=(double)i,.j=(double)j,.t=t,.r=hypot(x,y),.a=atan2(y,x),.n=(double)a->cur_col.count };
@@ -1126,150 +1607,1029 @@ static int pixel_color_code(App *a, int i,int j,double x,double y,double t){
     }
 }
 
-// ---- renderers (expr/mandelbrot/julia) with background substitution -------
-static void render_expr(App *a, double t){
-    const int w=a->tw;
-    const int content_h = a->th - a->info_rows;
-    double aspect = (double)w/(double)(content_h>0?content_h:1);
+// ---- cell grid: renderers fill it, emit_cells() encodes it to the tty ------
+static int app_grid_reserve(App *a, size_t n){
+    if(n<=a->grid_cap) return 0;
+    Cell *c=(Cell*)realloc(a->cells,n*sizeof(Cell)); if(!c) return -1;
+    a->cells=c;
+    int *it=(int*)realloc(a->iters,n*sizeof(int)); if(!it) return -1;
+    a->iters=it;
+    int *ir=(int*)realloc(a->iters_ref,n*sizeof(int)); if(!ir) return -1;
+    a->iters_ref=ir;
+    a->grid_cap=n;
+    return 0;
+}
+
+static void set_cell(App *a, Cell *c, const Glyph *g, int ci){
+    // substitute background when palette gives space
+    const Glyph *eg = g->is_space ? &a->bg.bg : g;
+    int want_color = (ci>=0) && !(a->cfg.transparent_ws && eg->is_space);
+    c->g = eg;
+    c->ci = want_color ? ci : -1;
+    c->bg = -1;
+}
 
-    for(int j=0;j<content_h;j++){
+static void emit_cells(const Cell *cells, int w, int h){
+    const double e0=now_sec();
+    for(int j=0;j<h;j++){
         term_move(j+1, 1);
-        int color_on=0, last_ci=-2;
+        int last_ci=-1, last_bg=-1;
+        const Cell *row = cells + (size_t)j*w;
 
         for(int i=0;i<w;i++){
-            double x = ( (double)i/(w-1)*2.0 - 1.0 ) * aspect;
-            double y = ( (double)j/((content_h-1>0)?(content_h-1):1)*2.0 - 1.0 );
-            Vars v = { .x=x,.y=y,.i=(double)i,.j=(double)j,.t=t,.r=hypot(x,y),.a=atan2(y,x),.n=0 };
-            double val = eval_expr(a->cfg.expr_value,&v);
-            if(val<-1) val=-1; else if(val>1) val=1;
-            size_t idx = cs_idx_from_value(&a->acs,val);
-            const Glyph *g = &a->acs.g[idx];
-            // substitute background when palette gives space
-            const Glyph *eg = g->is_space ? &a->bg.bg : g;
-
-            int ci;
-            if(a->cfg.color_func && a->cur_col.valid && a->cur_col.count>0){
-                int n=a->cur_col.count;
-                int cidx = (col_idx_from_value(&a->cur_col, val) + (int)lrint(t*20.0)) % n;
-                ci = a->cur_col.codes[cidx];
-            } else {
-                ci = pixel_color_code(a,i,j,x,y,t);
+            int ci=row[i].ci, bg=row[i].bg;
+            if(ci!=last_ci || bg!=last_bg){
+                // dropping a color takes a reset, which drops both
+                if((ci<0 && last_ci>=0) || (bg<0 && last_bg>=0)){ append_str("\x1b[0m"); last_ci=last_bg=-1; }
+                char esc[48]; int n=0;
+                if(ci>=0 && ci!=last_ci) n+=snprintf(esc+n,sizeof(esc)-n,"\x1b[38;5;%dm",ci);
+                if(bg>=0 && bg!=last_bg) n+=snprintf(esc+n,sizeof(esc)-n,"\x1b[48;5;%dm",bg);
+                if(n) term_write(esc,(size_t)n);
+                last_ci=ci; last_bg=bg;
             }
-            int want_color = (ci>=0) && !(a->cfg.transparent_ws && eg->is_space);
+            emit_glyph(row[i].g);
+        }
+        if(last_ci>=0 || last_bg>=0) append_str("\x1b[0m");
+    }
+    stats_add(STAGE_ENCODE, now_sec()-e0);
+}
+
+/* renderers finish here: the grid goes to the tty, or stays for compositing
+   when a is a layer */
+static void app_emit(App *a, int w, int h){
+    if(!a->is_layer) emit_cells(a->cells,w,h);
+    a->drawn_w=w; a->drawn_h=h;
+}
+
+// ---- renderers (expr/mandelbrot/julia) ------------------------------------
+static int app_cx_reserve(App *a, size_t n){
+    if(n<=a->cx_cap) return 0;
+    double *zr=(double*)realloc(a->cx_zr,n*sizeof(double)); if(!zr) return -1;
+    a->cx_zr=zr;
+    double *zi=(double*)realloc(a->cx_zi,n*sizeof(double)); if(!zi) return -1;
+    a->cx_zi=zi;
+    unsigned char *st=(unsigned char*)realloc(a->cx_state,n); if(!st) return -1;
+    a->cx_state=st;
+    int *b=(int*)realloc(a->cx_basin,n*sizeof(int)); if(!b) return -1;
+    a->cx_basin=b;
+    a->cx_cap=n;
+    return 0;
+}
+
+static int app_levels_reserve(App *a, size_t n){
+    if(n<=a->levels_cap) return 0;
+    float *l=(float*)realloc(a->levels,n*sizeof(float)); if(!l) return -1;
+    a->levels=l; a->levels_cap=n;
+    return 0;
+}
+
+static int app_aa_reserve(App *a, size_t n, int samples){
+    if(n>a->aa_cap){
+        unsigned char *m=(unsigned char*)realloc(a->aa_mark,n); if(!m) return -1;
+        a->aa_mark=m;
+        int *c=(int*)realloc(a->aa_ci,n*sizeof(int)); if(!c) return -1;
+        a->aa_ci=c;
+        a->aa_cap=n;
+    }
+    size_t ns=n*(size_t)samples;
+    if(ns>a->aa_samples_cap){
+        int *sm=(int*)realloc(a->aa_samples,ns*sizeof(int)); if(!sm) return -1;
+        a->aa_samples=sm; a->aa_samples_cap=ns;
+    }
+    return 0;
+}
+static int app_quant_reserve(App *a, size_t n){
+    if(n<=a->q_cap) return 0;
+    float *v=(float*)realloc(a->qv,n*sizeof(float)); if(!v) return -1;
+    a->qv=v;
+    int *c=(int*)realloc(a->qci,n*sizeof(int)); if(!c) return -1;
+    a->qci=c;
+    unsigned char *g=(unsigned char*)realloc(a->qg,n); if(!g) return -1;
+    a->qg=g;
+    unsigned char *q=(unsigned char*)realloc(a->qc,n); if(!q) return -1;
+    a->qc=q;
+    a->q_cap=n;
+    return 0;
+}
+
+#define CI_BY_VALUE (-2)   // emit_values: the palette step follows the cell's value
+
+/* last stage of the cell renderers: glyphs from val[] in -1..1, and palette
+   colors (rotated by shift steps) where ci[] is CI_BY_VALUE, both through
+   the [render] dither stage */
+static void emit_values(App *a, const float *val, const int *ci, int w, int h, int shift){
+    const size_t n=(size_t)w*h;
+    const DitherKind dk=(DitherKind)a->cfg.dither;
+    if(app_quant_reserve(a,n) || dither_quantize(dk,val,w,h,a->acs.count,a->qg,&a->dither,a->pool)) return;
+    const int pal = a->cur_col.valid && a->cur_col.count>0;
+    int by_value=0;
+    for(size_t k=0;k<n && pal && !by_value;k++) by_value = ci[k]==CI_BY_VALUE;
+    if(by_value && dither_quantize(dk,val,w,h,a->cur_col.count,a->qc,&a->dither,a->pool)) return;
+    for(size_t k=0;k<n;k++){
+        int c=ci[k];
+        if(c==CI_BY_VALUE) c = pal ? a->cur_col.codes[(a->qc[k]+shift) % a->cur_col.count] : -1;
+        set_cell(a,&a->cells[k],&a->acs.g[a->qg[k]],c);
+    }
+    app_emit(a,w,h);
+}
 
-            if(want_color){
-                if(!color_on || ci!=last_ci){
-                    char esc[32]; int n=snprintf(esc,sizeof(esc),"\x1b[38;5;%dm",ci);
-                    ssize_t w3=write(STDOUT_FILENO,esc,n); (void)w3;
-                    color_on=1; last_ci=ci;
+/* supersampling: flag cells whose glyph or color key differs from a
+   neighbour's; only those get extra samples. returns how many */
+static long aa_mark_edges(App *a, const float *val, const int *key, int w, int h){
+    unsigned char *m=a->aa_mark;
+    memset(m,0,(size_t)w*h);
+    long n=0;
+    for(int j=0;j<h;j++){
+        for(int i=0;i<w;i++){
+            const size_t k=(size_t)j*w+i;
+            const size_t g=cs_idx_from_value(&a->acs,val[k]);
+            if(i+1<w && (cs_idx_from_value(&a->acs,val[k+1])!=g || key[k+1]!=key[k])){ m[k]=m[k+1]=1; }
+            if(j+1<h && (cs_idx_from_value(&a->acs,val[k+w])!=g || key[k+w]!=key[k])){ m[k]=m[k+w]=1; }
+        }
+    }
+    for(size_t k=0;k<(size_t)w*h;k++) n+=m[k];
+    return n;
+}
+
+static int app_supersample(const App *a){
+    return a->cfg.supersample<0 ? 0 : a->cfg.supersample>FRAC_MAX_SAMPLES ? FRAC_MAX_SAMPLES : a->cfg.supersample;
+}
+
+/* sub-cell colors follow the sample value: the color palette when one is
+   active, else the 24-step grey ramp */
+static int value_color(const App *a, double v){
+    if(!a->cfg.use_color) return -1;
+    if(a->cur_col.valid && a->cur_col.count>0) return a->cur_col.codes[col_idx_from_value(&a->cur_col,v)];
+    return 232 + (int)lrint(clamp((v+1.0)*0.5,0.0,1.0)*23);
+}
+
+/* glyphs without a shape= descriptor take the built-in one if there is one */
+static void app_shape_map(App *a){
+    ActiveCharset *cs=&a->acs;
+    if(a->shape_map.valid) return;
+    for(int k=0;k<cs->count;k++)
+        if(!cs->shape_known[k]) cs->shape_known[k]=(unsigned char)shape_builtin(cs->g[k].glyph,&cs->shape[k]);
+    shape_build(&a->shape_map,cs->shape,cs->shape_known,cs->count);
+}
+
+/* pack a (w*sx) x (h*sy) grid of values in -1..1 into w x h cells. braille
+   lights the dots above zero and takes the cell mean as its color; half
+   blocks carry the two values as fg/bg colors, or as a mask without color;
+   shape picks the charset glyph whose coverage best matches the samples */
+static void emit_subcells(App *a, const float *val, int w, int h){
+    const int sx=SUBCELL_INFO[a->cfg.subcell].sx, sy=SUBCELL_INFO[a->cfg.subcell].sy, W=w*sx;
+    if(a->cfg.subcell==SUBCELL_SHAPE) app_shape_map(a);
+    // dots and mono half blocks are two-level: dither which samples are on
+    const unsigned char *on=NULL;
+    if(a->cfg.dither && (a->cfg.subcell==SUBCELL_BRAILLE || (a->cfg.subcell==SUBCELL_HALF && !a->cfg.use_color))){
+        if(app_quant_reserve(a,(size_t)W*h*sy) || dither_quantize((DitherKind)a->cfg.dither,val,W,h*sy,2,a->qg,&a->dither,a->pool)) return;
+        on=a->qg;
+    }
+    for(int j=0;j<h;j++){
+        for(int i=0;i<w;i++){
+            Cell *c=&a->cells[(size_t)j*w+i];
+            const size_t o=(size_t)j*sy*W + (size_t)i*sx;
+            const float *v=val+o;
+            if(a->cfg.subcell==SUBCELL_HALF){
+                if(a->cfg.use_color){
+                    c->g=&g_half[1]; c->ci=value_color(a,v[0]); c->bg=value_color(a,v[W]);
+                }else{
+                    c->g = on ? &g_half[on[o] | on[o+W]<<1] : &g_half[(v[0]>0) | (v[W]>0)<<1];
+                    c->ci=-1; c->bg=-1;
                 }
-            }else{
-                if(color_on){ append_str("\x1b[0m"); color_on=0; last_ci=-2; }
+                continue;
+            }
+            if(a->cfg.subcell==SUBCELL_SHAPE){
+                double sum=0;
+                for(int y=0;y<SHAPE_ROWS;y++) for(int x=0;x<SHAPE_COLS;x++) sum+=v[(size_t)y*W+x];
+                set_cell(a,c,&a->acs.g[a->shape_map.lut[shape_key(v,W)]],value_color(a,sum/SHAPE_N));
+                continue;
             }
-            emit_glyph(eg);
+            int mask=0; double sum=0;
+            for(int y=0;y<4;y++) for(int x=0;x<2;x++){
+                const size_t d=(size_t)y*W+x;
+                sum+=v[d];
+                if(on ? on[o+d] : v[d]>0) mask|=BRAILLE_BIT[y][x];
+            }
+            set_cell(a,c,&g_braille[mask],mask ? value_color(a,sum/8) : -1);
         }
-        if(color_on) append_str("\x1b[0m");
     }
+    app_emit(a,w,h);
+}
+
+typedef struct { int mode, n, age; unsigned frame; unsigned char *ages; } Temporal;
+
+/* set up this frame's temporal pass over n cells: NULL when every cell is
+   evaluated. the kept cells are dropped when the grid, the expressions or
+   the coloring changed; palette and preset switches clear tmp_valid */
+static const Temporal *app_temporal(App *a, Temporal *T, size_t n, int w, int h){
+    char src[sizeof(a->tmp_src)];
+    const int color = a->cfg.use_color | a->cfg.color_func<<1;
+    if(a->cfg.temporal==TEMPORAL_OFF || a->run_mode==RUNMODE_EDITOR){ a->tmp_valid=0; return NULL; }
+    if(n>a->tmp_cap){
+        float *v=(float*)realloc(a->tmp_v,n*sizeof(float)); if(!v) return NULL;
+        a->tmp_v=v;
+        int *c=(int*)realloc(a->tmp_ci,n*sizeof(int)); if(!c) return NULL;
+        a->tmp_ci=c;
+        unsigned char *g=(unsigned char*)realloc(a->tmp_age,n); if(!g) return NULL;
+        a->tmp_age=g; a->tmp_cap=n; a->tmp_valid=0;
+    }
+    snprintf(src,sizeof(src),"%s\n%s",a->cfg.expr_value,a->cfg.expr_color);
+    if(!a->tmp_valid || a->tmp_w!=w || a->tmp_h!=h || a->tmp_color!=color || strcmp(src,a->tmp_src)){
+        memset(a->tmp_age,255,n);   // older than any age limit: all due
+        strcpy(a->tmp_src,src);
+        a->tmp_w=w; a->tmp_h=h; a->tmp_color=color; a->tmp_valid=1;
+    }
+    T->mode = a->cfg.temporal;
+    T->n = a->cfg.temporal==TEMPORAL_STRIDE ? a->cfg.temporal_n : 2;
+    T->age = a->cfg.temporal_age<1 ? 1 : a->cfg.temporal_age>254 ? 254 : a->cfg.temporal_age;
+    T->frame = a->tmp_frame++;
+    T->ages = a->tmp_age;
+    return T;
+}
+
+/* 1 if cell k at (i,j) is evaluated this frame, else it ages by one */
+static inline int temporal_take(const Temporal *T, size_t k, int i, int j){
+    if(!T) return 1;
+    unsigned p;
+    if(T->mode==TEMPORAL_ROWS) p = (unsigned)j + T->frame;
+    else if(T->mode==TEMPORAL_CHECKER) p = (unsigned)(i+j) + T->frame;
+    else p = (unsigned)i + (unsigned)j*((T->n+1)/2) + T->frame;
+    if(p % (unsigned)T->n==0 || T->ages[k]>=T->age){ T->ages[k]=0; return 1; }
+    T->ages[k]++;
+    return 0;
 }
 
-static void render_mandel(App *a){
-    const int w=a->tw;
-    const int content_h = a->th - a->info_rows;
-    const double ar = (double)content_h/(double)(w>0?w:1);
-    double t = now_sec() - a->t0;
+static const char *const EXPR_VARS[EXPR_NVARS] = { "x", "y", "i", "j", "t", "r", "a", "n" };
 
-    for(int j=0;j<content_h;j++){
-        term_move(j+1, 1);
-        int color_on=0, last_ci=-2;
+enum { EXPR_OUT_VALUE, EXPR_OUT_COLOR, EXPR_OUT_INDEX, EXPR_OUT_FIELDS };
 
-        for(int i=0;i<w;i++){
-            double x0 = a->cfg.cx + ( (double)i/(w-1)-0.5 ) * a->cfg.scale;
-            double y0 = a->cfg.cy + ( (double)j/((content_h-1>0)?(content_h-1):1)-0.5 ) * a->cfg.scale * ar;
-            double x=0,y=0; int iter=0; const int max=a->cfg.max_iter;
-            while(x*x+y*y<=4.0 && iter<max){
-                double xt = x*x - y*y + x0;
-                y = 2*x*y + y0;
-                x = xt;
-                iter++;
+typedef struct {
+    const App *a;
+    const ExprPlan *P;
+    int kind;                    // EXPR_OUT_*
+    float *out; int *ci;         // W*H values / color codes
+    int W, H, sx, sy;
+    double aspect, t;
+    const Temporal *tmp;
+    int follow;                  // take the cells the value pass took
+} ExprJob;
+
+static inline int expr_due(const ExprJob *E, size_t k, int i, int j){
+    if(!E->tmp) return 1;
+    return E->follow ? E->tmp->ages[k]==0 : temporal_take(E->tmp,k,i,j);
+}
+
+static inline double expr_x(const ExprJob *E, int I){ return ( (double)I/(E->W>1?E->W-1:1)*2.0 - 1.0 ) * E->aspect; }
+static inline double expr_y(const ExprJob *E, int J){ return (double)J/((E->H-1>0)?(E->H-1):1)*2.0 - 1.0; }
+
+/* one row of samples, RX_BATCH lanes per call; under temporal the lanes are
+   gathered from the samples due this frame. non-finite results count as 0,
+   as in the interpreter */
+static void expr_sample_row(void *ctx, int J){
+    const ExprJob *E=(const ExprJob*)ctx;
+    const ExprPlan *P=E->P;
+    const size_t plane=(size_t)E->W*E->H, row=(size_t)J*E->W;
+    double v[EXPR_NVARS+EXPR_FIELDS][RX_BATCH], out[RX_BATCH];
+    const double *in[EXPR_NVARS+EXPR_FIELDS];
+    int lane[RX_BATCH];
+    unsigned uses=P->prog.uses;
+    if(E->kind==EXPR_OUT_FIELDS) for(int f=0;f<P->nfields;f++) uses |= P->field[f].uses;
+    for(int q=0;q<EXPR_NVARS+EXPR_FIELDS;q++) in[q]=v[q];
+    const double yy=expr_y(E,J);
+    for(int I0=0;I0<E->W;){
+        int m=0;
+        for(;I0<E->W && m<RX_BATCH;I0++)
+            if(expr_due(E,row+I0,I0,J)) lane[m++]=I0;
+        if(!m) break;
+        for(int k=0;k<m;k++){
+            const int I=lane[k];
+            v[0][k] = expr_x(E,I); v[1][k] = yy;
+            v[2][k] = (double)I/E->sx; v[3][k] = (double)J/E->sy;
+            v[4][k] = E->t; v[7][k] = P->n;
+        }
+        if(uses & 1u<<5) for(int k=0;k<m;k++) v[5][k]=hypot(v[0][k],v[1][k]);
+        if(uses & 1u<<6) for(int k=0;k<m;k++) v[6][k]=atan2(v[1][k],v[0][k]);
+        if(E->kind==EXPR_OUT_FIELDS){
+            for(int f=0;f<P->nfields;f++){
+                rx_eval(&P->field[f],m,in,out);
+                for(int k=0;k<m;k++) P->data[f*plane + row + lane[k]] = out[k];
             }
-            double tval = (iter>=max)? -1.0 : (double)iter/(double)max*2.0-1.0;
-            size_t idx = cs_idx_from_value(&a->acs,tval);
-            const Glyph *g = &a->acs.g[idx];
-            const Glyph *eg = g->is_space ? &a->bg.bg : g;
-
-            int ci;
-            if(a->cfg.color_func && a->cur_col.valid && a->cur_col.count>0){
-                int n=a->cur_col.count;
-                int cidx = (iter + (int)lrint(t*20.0)) % n;
-                ci = a->cur_col.codes[cidx];
-            } else {
-                ci = pixel_color_code(a,i,j,x0,y0,t);
+            continue;
+        }
+        for(int f=0;f<P->nfields;f++){
+            const double *d=P->data + f*plane + row;
+            for(int k=0;k<m;k++) v[EXPR_NVARS+f][k]=d[lane[k]];
+        }
+        rx_eval(&P->prog,m,in,out);
+        for(int k=0;k<m;k++){
+            const double o = isfinite(out[k]) ? out[k] : 0.0;
+            const size_t at = row + lane[k];
+            if(E->kind==EXPR_OUT_VALUE) E->out[at] = (float)clamp(o,-1.0,1.0);
+            else if(E->kind==EXPR_OUT_COLOR) E->ci[at] = (int)lrint(clamp(o,0.0,255.0));
+            else{
+                const int n=E->a->cur_col.count;
+                const long idx=(long)floor(o);
+                E->ci[at] = E->a->cur_col.codes[(idx % n + n) % n];
             }
-            int want_color = (ci>=0) && !(a->cfg.transparent_ws && eg->is_space);
+        }
+    }
+}
 
-            if(want_color){
-                if(!color_on || ci!=last_ci){
-                    char esc[32]; int n=snprintf(esc,sizeof(esc),"\x1b[38;5;%dm",ci);
-                    ssize_t w4=write(STDOUT_FILENO,esc,n); (void)w4;
-                    color_on=1; last_ci=ci;
-                }
-            }else{
-                if(color_on){ append_str("\x1b[0m"); color_on=0; last_ci=-2; }
+// the same through the interpreter, for sources the compiler refuses
+static void expr_interp(const ExprJob *E){
+    for(int J=0;J<E->H;J++) for(int I=0;I<E->W;I++){
+        const size_t k=(size_t)J*E->W+I;
+        if(!expr_due(E,k,I,J)) continue;
+        const double x=expr_x(E,I), y=expr_y(E,J);
+        if(E->kind==EXPR_OUT_VALUE){
+            Vars v = { .x=x,.y=y,.i=(double)I/E->sx,.j=(double)J/E->sy,.t=E->t,.r=hypot(x,y),.a=atan2(y,x),.n=0 };
+            E->out[k] = (float)clamp(eval_expr(E->a->cfg.expr_value,&v),-1.0,1.0);
+        }else E->ci[k] = pixel_color_code(E->a,I,J,x,y,E->t);
+    }
+}
+
+static size_t app_field_budget(const App *a){
+    return (size_t)(a->cfg.field_mb>0 ? a->cfg.field_mb : 0) << 20;
+}
+
+/* make P evaluate src over a W x H grid of sx x sy samples per cell, keeping
+   as many fields as fit in budget bytes. rebuilt only when one of those
+   changed. returns the bytes its fields hold */
+static size_t expr_plan_prepare(const App *a, ExprPlan *P, const char *src, double n, int W, int H, int sx, int sy, size_t budget){
+    const size_t plane=(size_t)W*H;
+    const size_t fit=budget/(plane*sizeof(double));
+    const int maxf = fit>EXPR_FIELDS ? EXPR_FIELDS : (int)fit;
+    if(P->W==W && P->H==H && P->sx==sx && P->sy==sy && P->n==n && P->maxf==maxf && !strcmp(P->src,src))
+        return (size_t)P->nfields*plane*sizeof(double);
+    char err[96];
+    snprintf(P->src,sizeof(P->src),"%s",src);
+    P->W=W; P->H=H; P->sx=sx; P->sy=sy; P->n=n; P->maxf=maxf; P->nfields=0;
+    P->ok = !rx_compile(&P->prog,P->src,EXPR_VARS,EXPR_NVARS,err,sizeof(err));
+    P->whole=P->prog;
+    if(!P->ok || !maxf) return 0;
+    const int nf=rx_hoist(&P->prog,1u<<4,EXPR_NVARS,P->field,maxf);   // fields: whatever doesn't read t
+    if(nf && (size_t)nf*plane>P->cap){
+        double *d=(double*)realloc(P->data,(size_t)nf*plane*sizeof(double));
+        if(!d){ P->prog=P->whole; return 0; }
+        P->data=d; P->cap=(size_t)nf*plane;
+    }
+    P->nfields=nf;
+    if(nf){
+        ExprJob E = { a, P, EXPR_OUT_FIELDS, NULL, NULL, W, H, sx, sy, (double)(W/sx)/(double)(H/sy), 0.0, NULL, 0 };
+        pool_for(a->pool,H,expr_sample_row,&E);
+    }
+    return (size_t)nf*plane*sizeof(double);
+}
+
+/* supersampling: an edge cell takes ss more samples jittered inside it,
+   whole cells to a batch of lanes. the value and the color expression are
+   both averaged before they are quantized */
+typedef struct {
+    const App *a;
+    const ExprPlan *vp, *cp;     // cp NULL: the color doesn't come from an expression
+    const char *csrc;            // what cp was compiled from, for the interpreter
+    int kind;                    // cp's EXPR_OUT_COLOR / EXPR_OUT_INDEX
+    float *lv; int *ci;
+    int w, h, ss;
+    double aspect, t;
+} ExprAaJob;
+
+static void expr_aa_eval(const ExprPlan *P, const char *src, int m, const double *const *in, double *out){
+    if(P->ok) rx_eval(&P->whole,m,in,out);
+    else for(int k=0;k<m;k++){
+        Vars v = { .x=in[0][k],.y=in[1][k],.i=in[2][k],.j=in[3][k],.t=in[4][k],.r=in[5][k],.a=in[6][k],.n=in[7][k] };
+        out[k]=eval_expr(src,&v);
+    }
+    for(int k=0;k<m;k++) if(!isfinite(out[k])) out[k]=0.0;
+}
+
+static void expr_aa_row(void *ctx, int j){
+    const ExprAaJob *A=(const ExprAaJob*)ctx;
+    const int per=A->ss+1, fit=RX_BATCH/per;
+    const double xd=A->w>1 ? A->w-1 : 1, yd=A->h>1 ? A->h-1 : 1;
+    double v[EXPR_NVARS][RX_BATCH], val[RX_BATCH], col[RX_BATCH];
+    const double *in[EXPR_NVARS];
+    int cell[RX_BATCH];
+    for(int q=0;q<EXPR_NVARS;q++) in[q]=v[q];
+    for(int i0=0;i0<A->w;){
+        int m=0, nc=0;
+        for(;i0<A->w && nc<fit;i0++){
+            if(!A->a->aa_mark[(size_t)j*A->w+i0]) continue;
+            cell[nc++]=i0;
+            for(int s=0;s<per;s++){   // sample 0 is the cell's own point
+                double di=0, dj=0;
+                if(s) frac_jitter(s-1,&di,&dj);
+                const double x=((i0+di)/xd*2.0-1.0)*A->aspect, y=(j+dj)/yd*2.0-1.0;
+                v[0][m]=x; v[1][m]=y; v[2][m]=i0+di; v[3][m]=j+dj;
+                v[4][m]=A->t; v[5][m]=hypot(x,y); v[6][m]=atan2(y,x); v[7][m]=0;
+                m++;
+            }
+        }
+        if(!nc) break;
+        expr_aa_eval(A->vp,A->a->cfg.expr_value,m,in,val);
+        if(A->cp){
+            for(int k=0;k<m;k++) v[7][k]=A->cp->n;
+            expr_aa_eval(A->cp,A->csrc,m,in,col);
+        }
+        for(int c=0;c<nc;c++){
+            const size_t k=(size_t)j*A->w+cell[c];
+            double sv=0, sc=0;
+            for(int s=0;s<per;s++) sv+=clamp(val[c*per+s],-1.0,1.0);
+            A->lv[k]=(float)(sv/per);
+            if(!A->cp) continue;
+            for(int s=0;s<per;s++) sc+=col[c*per+s];
+            sc/=per;
+            if(A->kind==EXPR_OUT_COLOR) A->ci[k]=(int)lrint(clamp(sc,0.0,255.0));
+            else{
+                const int n=A->a->cur_col.count;
+                const long idx=(long)floor(sc);
+                A->ci[k]=A->a->cur_col.codes[(idx % n + n) % n];
             }
-            emit_glyph(eg);
         }
-        if(color_on) append_str("\x1b[0m");
     }
 }
 
-static void render_julia(App *a){
+static void render_expr_subcell(App *a, double t){
+    const int w=a->tw, h=a->th - a->info_rows;
+    const int sx=SUBCELL_INFO[a->cfg.subcell].sx, sy=SUBCELL_INFO[a->cfg.subcell].sy;
+    const size_t n=(size_t)w*sx*h*sy;
+    if(w<=0 || h<=0 || app_grid_reserve(a,(size_t)w*h) || app_levels_reserve(a,n)) return;
+    expr_plan_prepare(a,&a->expr_plan,a->cfg.expr_value,0,w*sx,h*sy,sx,sy,app_field_budget(a));
+    Temporal T;
+    const Temporal *tp=app_temporal(a,&T,n,w*sx,h*sy);
+    ExprJob E = { a, &a->expr_plan, EXPR_OUT_VALUE, tp ? a->tmp_v : a->levels, NULL, w*sx, h*sy, sx, sy, (double)w/(double)h, t, tp, 0 };
+    if(a->expr_plan.ok) pool_for(a->pool,E.H,expr_sample_row,&E);
+    else expr_interp(&E);   // the compiler refused it: the interpreter reads it its own lenient way
+    emit_subcells(a,E.out,w,h);
+}
+
+static void render_expr(App *a, double t){
+    if(a->cfg.subcell){ render_expr_subcell(a,t); return; }
     const int w=a->tw;
     const int content_h = a->th - a->info_rows;
-    const double ar = (double)content_h/(double)(w>0?w:1);
-    double t = now_sec() - a->t0;
+    const size_t cells=(size_t)w*content_h;
+    const int ss=app_supersample(a);
+    if(w<=0 || content_h<=0 || app_grid_reserve(a,cells) || app_levels_reserve(a,cells) || app_aa_reserve(a,cells,0)) return;
+    double aspect = (double)w/(double)(content_h>0?content_h:1);
+    const int pal = a->cfg.color_func && a->cur_col.valid && a->cur_col.count>0;
+    float *lv=a->levels;
+    int *ci=a->aa_ci;
+    const size_t budget=app_field_budget(a);
+    const size_t used=expr_plan_prepare(a,&a->expr_plan,a->cfg.expr_value,0,w,content_h,1,1,budget);
+
+    // temporal: cells not due this frame keep their value and color
+    Temporal T;
+    const Temporal *tp=app_temporal(a,&T,cells,w,content_h);
+    ExprJob E = { a, &a->expr_plan, EXPR_OUT_VALUE, tp ? a->tmp_v : lv, tp ? a->tmp_ci : ci, w, content_h, 1, 1, aspect, t, tp, 0 };
+    if(a->expr_plan.ok) pool_for(a->pool,content_h,expr_sample_row,&E);
+    else expr_interp(&E);
+    const int idx = a->cur_col.valid && a->cur_col.count>0;
+    if(!a->cfg.use_color) for(size_t k=0;k<cells;k++) E.ci[k]=-1;
+    else if(!pal){   // color from [expr] color, or the palette's index expression
+        expr_plan_prepare(a,&a->color_plan, idx ? a->cur_col.index_expr : a->cfg.expr_color, idx ? a->cur_col.count : 0,
+                          w,content_h,1,1, budget>used ? budget-used : 0);
+        E.P=&a->color_plan; E.kind = idx ? EXPR_OUT_INDEX : EXPR_OUT_COLOR; E.follow=1;
+        if(a->color_plan.ok) pool_for(a->pool,content_h,expr_sample_row,&E);
+        else expr_interp(&E);
+    }
+    if(tp){ memcpy(lv,a->tmp_v,cells*sizeof(float)); memcpy(ci,a->tmp_ci,cells*sizeof(int)); }
+    if(pal){
+        const int n=a->cur_col.count, shift=(int)lrint(t*20.0);
+        for(size_t k=0;k<cells;k++) ci[k] = a->cur_col.codes[(col_idx_from_value(&a->cur_col,lv[k]) + shift) % n];
+    }
 
-    for(int j=0;j<content_h;j++){
-        term_move(j+1, 1);
-        int color_on=0, last_ci=-2;
+    if(ss && aa_mark_edges(a,lv,ci,w,content_h)){
+        const int cx = a->cfg.use_color && !pal;
+        ExprAaJob A = { a, &a->expr_plan, cx ? &a->color_plan : NULL, idx ? a->cur_col.index_expr : a->cfg.expr_color,
+                        idx ? EXPR_OUT_INDEX : EXPR_OUT_COLOR, lv, ci, w, content_h, ss, aspect, t };
+        // the interpreter stays on this thread, as in expr_interp
+        if(a->expr_plan.ok && (!cx || a->color_plan.ok)) pool_for(a->pool,content_h,expr_aa_row,&A);
+        else for(int j=0;j<content_h;j++) expr_aa_row(&A,j);
+    }
+    if(pal) for(size_t k=0;k<cells;k++) ci[k]=CI_BY_VALUE;
+    emit_values(a,lv,ci,w,content_h,(int)lrint(t*20.0));
+}
 
-        for(int i=0;i<w;i++){
-            double zx = a->cfg.cx + ( (double)i/(w-1)-0.5 ) * a->cfg.scale;
-            double zy = a->cfg.cy + ( (double)j/((content_h-1>0)?(content_h-1):1)-0.5 ) * a->cfg.scale * ar;
-            int iter=0; const int max=a->cfg.max_iter;
-            while(zx*zx+zy*zy<=4.0 && iter<max){
-                double xt = zx*zx - zy*zy + a->cfg.j_re;
-                zy = 2*zx*zy + a->cfg.j_im;
-                zx = xt;
-                iter++;
-            }
-            double tval = (iter>=max)? -1.0 : (double)iter/(double)max*2.0-1.0;
-            size_t idx = cs_idx_from_value(&a->acs,tval);
-            const Glyph *g = &a->acs.g[idx];
-            const Glyph *eg = g->is_space ? &a->bg.bg : g;
+static void app_frac_view(const App *a, FracView *v){
+    memset(v,0,sizeof(*v));
+    v->w = a->tw;
+    v->h = a->th - a->info_rows;
+    if(mode_escape(a->cfg.mode)){   // escape-time views sample sub-cells
+        v->w *= SUBCELL_INFO[a->cfg.subcell].sx;
+        v->h *= SUBCELL_INFO[a->cfg.subcell].sy;
+    }
+    frac_view_set_center(v, &a->cfg.hcx, &a->cfg.hcy);
+    v->scale = a->cfg.scale;
+    v->formula = MODE_INFO[a->cfg.mode].formula;
+    v->power = a->cfg.power;
+    if(v->formula==FRAC_ZPOW && v->power==2) v->formula=FRAC_Z2;
+    v->julia = MODE_INFO[a->cfg.mode].julia || (a->cfg.julia_seed && a->cfg.mode!=MODE_MANDELBROT);
+    v->j_re = a->cfg.j_re; v->j_im = a->cfg.j_im;
+    v->max_iter = a->cfg.max_iter;
+    v->smooth = a->cfg.frac_smooth && mode_escape(a->cfg.mode);
+    v->prec = frac_pick_prec(v, a->cfg.frac_prec);
+    v->series = a->cfg.frac_series;
+    v->ref = (v->prec==FRAC_PREC_PERTURB) ? &a->frac_ref : NULL;
+}
+
+/* pan in full precision so deep views don't snap to the double grid */
+static void app_pan(App *a, double dx, double dy){
+    mp_add_double(&a->cfg.hcx, dx);
+    mp_add_double(&a->cfg.hcy, dy);
+    a->cfg.cx = mp_to_double(&a->cfg.hcx);
+    a->cfg.cy = mp_to_double(&a->cfg.hcy);
+}
+
+static int input_pending(void *ctx){
+    (void)ctx;
+    if(g_headless) return 0;
+    struct pollfd pfd = { .fd=STDIN_FILENO, .events=POLLIN, .revents=0 };
+    return poll(&pfd,1,0)>0;
+}
+
+#define FRAC_COARSE_STEP 4
+
+// the full-resolution buffer is final: keep it for revisits, check it if asked
+static void frac_finish(App *a, const FracView *v){
+    frac_cache_put(&a->frac_cache,v,a->iters);
+    if(!a->cfg.frac_validate || a->cfg.frac_method==FRAC_BRUTE) return;
+    frac_render_brute(v,a->iters_ref);
+    a->frac_mismatch = frac_compare(a->iters,a->iters_ref,(size_t)v->w*v->h,v->smooth ? FRAC_SMOOTH : 1);
+    a->frac_checked_frames++;
+    if(a->frac_mismatch) a->frac_bad_frames++;
+}
+
+/* compute the next pass for the current view: a coarse pass right after a
+   change, then finer ones while the view holds still, then nothing at all.
+   past iter_budget, every cell's orbit instead advances that many iterations
+   per frame and the image sharpens as cells resolve */
+static void frac_refine(App *a, FracView *v){
+    a->frac_cache.limit = (size_t)(a->cfg.frac_cache_mb>0 ? a->cfg.frac_cache_mb : 0) << 20;
+    if(!frac_view_eq(v,&a->frac_view)){
+        /* a cached view only needs recoloring, but supersamples, budgeted
+           orbits and the hud still iterate it against the reference orbit */
+        int hit = frac_cache_get(&a->frac_cache,v,a->iters);
+        if(!hit && a->path_on) hit = path_ahead_take(&a->ahead,a->path_frame,v,a->iters);
+        if(v->ref && frac_ref_prepare(&a->frac_ref,v)){ v->prec=FRAC_PREC_DOUBLE; v->ref=NULL; }
+        a->frac_view=*v; a->frac_step=hit; a->frac_orbit_on=0;
+    }
+    a->frac_computed = 0;
+    if(a->frac_step==1) return;
+
+    if(a->cfg.frac_budget>0 && v->max_iter>a->cfg.frac_budget){
+        if(!a->frac_orbit_on && !frac_orbit_reset(&a->frac_orbit,v,a->iters)) a->frac_orbit_on=1;
+        if(a->frac_orbit_on){
+            a->frac_computed = frac_orbit_advance(&a->frac_orbit,v,a->cfg.frac_budget,a->iters);
+            if(a->frac_orbit.pending==0){ a->frac_step=1; frac_finish(a,v); }
+            return;
+        }
+    }
+
+    int step = a->frac_step ? a->frac_step/2 : (a->cfg.frac_progressive ? FRAC_COARSE_STEP : 1);
+    if(step==1 && a->cfg.frac_method==FRAC_SUBDIV){
+        a->frac_computed = frac_render_subdiv(v,a->iters);
+    }else{
+        // the first pass after a change always completes; refinement yields to input
+        long n = frac_render_step(v,a->iters,step,a->frac_step,a->frac_step?input_pending:NULL,NULL);
+        if(n<0) return;
+        a->frac_computed = n;
+    }
+    a->frac_step = step;
+    if(step==1) frac_finish(a,v);
+}
+
+/* move the camera along [path]; once a non-looping path ends the view
+   stays on its last key and the keys take over again */
+static void app_path_apply(App *a, double t, int fps){
+    if(a->cfg.mode==MODE_EXPR || a->cfg.path.n==0){
+        a->path_on=0;
+        path_ahead_stop(&a->ahead);
+        return;
+    }
+    int frame = (int)floor(t*fps);
+    PathKey k;
+    int on = path_eval(&a->cfg.path,(double)frame/fps,&k);
+    if(on || a->path_on){
+        a->cfg.hcx=k.cx; a->cfg.hcy=k.cy;
+        a->cfg.cx=mp_to_double(&k.cx); a->cfg.cy=mp_to_double(&k.cy);
+        a->cfg.scale=k.scale;
+        a->cfg.j_re=k.j_re; a->cfg.j_im=k.j_im;
+        a->cfg.max_iter=k.max_iter;
+    }
+    a->path_on=on; a->path_frame=frame; a->path_t=k.t;
+    if(!on) return;
+    if(!mode_escape(a->cfg.mode)){ path_ahead_stop(&a->ahead); return; }   // the worker only has escape kernels
+    PathTarget tg;
+    memset(&tg,0,sizeof(tg));
+    FracView fv; app_frac_view(a,&fv);
+    tg.w=fv.w; tg.h=fv.h;
+    tg.formula=fv.formula; tg.power=fv.power;
+    tg.julia=fv.julia; tg.series=a->cfg.frac_series; tg.smooth=fv.smooth; tg.fps=fps;
+    tg.prec=a->cfg.frac_prec; tg.method=a->cfg.frac_method;
+    path_ahead_sync(&a->ahead,&a->cfg.path,&tg,frame);
+}
+
+// evaluating the path (and keeping the lookahead fed) is eval time
+static void app_path_step(App *a, double t, int fps){
+    const double p0=now_sec();
+    app_path_apply(a,t,fps);
+    stats_add(STAGE_EVAL, now_sec()-p0);
+}
+
+/* julia colors have always been given the z its orbit ended on, not the
+   cell's point; it is kept with the view like the iterations, and only
+   worked out once the view is finished */
+typedef struct { const FracView *v; double *re, *im; } JuliaJob;
+
+static void julia_end_row(void *ctx, int j){
+    const JuliaJob *J=(const JuliaJob*)ctx;
+    const FracView *v=J->v;
+    for(int i=0;i<v->w;i++){
+        double zx,zy; frac_pixel(v,i,j,&zx,&zy);
+        for(int iter=0; zx*zx+zy*zy<=4.0 && iter<v->max_iter; iter++){
+            const double xt = zx*zx - zy*zy + v->j_re;
+            zy = 2*zx*zy + v->j_im;
+            zx = xt;
+        }
+        J->re[(size_t)j*v->w+i]=zx; J->im[(size_t)j*v->w+i]=zy;
+    }
+}
 
+static int julia_orbit_ends(App *a, const FracView *v){
+    const size_t n=(size_t)v->w*v->h;
+    if(n>a->jz_cap){
+        double *re=(double*)realloc(a->jz_re,n*sizeof(double)); if(!re) return -1;
+        a->jz_re=re;
+        double *im=(double*)realloc(a->jz_im,n*sizeof(double)); if(!im) return -1;
+        a->jz_im=im;
+        a->jz_cap=n;
+    }
+    JuliaJob J={ v, a->jz_re, a->jz_im };
+    pool_for(a->pool,v->h,julia_end_row,&J);
+    return 0;
+}
+
+static double frac_tval(const App *a, int iter, int inside, int eq){
+    if(iter>=inside) return -1.0;
+    return (eq ? frac_eq_map(&a->frac_eq,iter) : (double)iter/(double)inside)*2.0-1.0;
+}
+
+static void render_fractal(App *a, double t){
+    FracView v; app_frac_view(a,&v);
+    const size_t cells=(size_t)v.w*v.h;
+    const int ss=app_supersample(a);
+    if(v.w<=0 || v.h<=0 || app_grid_reserve(a,cells) || app_levels_reserve(a,cells) || app_aa_reserve(a,cells,ss)) return;
+    const int changed = !frac_view_eq(&v,&a->frac_view);
+    frac_refine(a,&v);
+    const int inside=frac_inside(&v);
+    if(changed || a->frac_computed) a->frac_eq_valid=a->aa_valid=a->jz_valid=0;
+    if(a->cfg.frac_equalize && !a->frac_eq_valid)
+        a->frac_eq_valid = !frac_eq_build(&a->frac_eq,a->iters,cells,inside);
+    const int eq = a->cfg.frac_equalize && a->frac_eq_valid;
+    const int unit = v.smooth ? FRAC_SMOOTH : 1;
+    const int pal = a->cfg.color_func && a->cur_col.valid && a->cur_col.count>0;
+
+    /* a finished view is supersampled once: edge cells (glyph or palette
+       step changes) average ss jittered samples, and the result is kept
+       until the iterations change */
+    float *lv=a->levels;
+    const int steps = pal ? a->cur_col.count : 0;
+    if(a->aa_glyphs!=a->acs.count || a->aa_steps!=steps || a->aa_eq!=eq) a->aa_valid=0;
+    if(!a->aa_valid || !ss || a->frac_step!=1){
+        for(size_t k=0;k<cells;k++) lv[k]=(float)frac_tval(a,a->iters[k],inside,eq);
+        a->aa_valid=0;
+    }
+    if(ss && a->frac_step==1 && !a->aa_valid){
+        int *key=a->aa_ci;
+        for(size_t k=0;k<cells;k++) key[k] = pal ? (a->iters[k]/unit) % steps : 0;
+        if(aa_mark_edges(a,lv,key,v.w,v.h)){
+            frac_render_samples(&v,a->aa_mark,ss,a->aa_samples);
+            for(size_t k=0;k<cells;k++){
+                if(!a->aa_mark[k]) continue;
+                double sum=lv[k];
+                for(int s=0;s<ss;s++) sum += frac_tval(a,a->aa_samples[k*ss+s],inside,eq);
+                lv[k]=(float)(sum/(ss+1));
+            }
+        }
+        a->aa_valid=1; a->aa_glyphs=a->acs.count; a->aa_steps=steps; a->aa_eq=eq;
+    }
+    if(a->cfg.subcell){ emit_subcells(a,lv,a->tw,a->th - a->info_rows); return; }
+    if(app_quant_reserve(a,cells)) return;
+    const int jz = a->cfg.mode==MODE_JULIA && !pal && a->cfg.use_color;
+    // coarse and budgeted passes color by the cell's point until the view is done
+    if(jz && !a->jz_valid && a->frac_step==1) a->jz_valid = !julia_orbit_ends(a,&v);
+
+    for(int j=0;j<v.h;j++){
+        for(int i=0;i<v.w;i++){
+            int iter = a->iters[(size_t)j*v.w+i];
             int ci;
-            if(a->cfg.color_func && a->cur_col.valid && a->cur_col.count>0){
+            if(pal){
                 int n=a->cur_col.count;
-                int cidx = (iter + (int)lrint(t*20.0)) % n;
+                int cidx = (iter/unit + (int)lrint(t*20.0)) % n;
                 ci = a->cur_col.codes[cidx];
             } else {
-                ci = pixel_color_code(a,i,j,zx,zy,t);
+                double x0,y0;
+                if(jz && a->jz_valid){ x0=a->jz_re[(size_t)j*v.w+i]; y0=a->jz_im[(size_t)j*v.w+i]; }
+                else frac_pixel(&v,i,j,&x0,&y0);
+                ci = pixel_color_code(a,i,j,x0,y0,t);
             }
-            int want_color = (ci>=0) && !(a->cfg.transparent_ws && eg->is_space);
-
-            if(want_color){
-                if(!color_on || ci!=last_ci){
-                    char esc[32]; int n=snprintf(esc,sizeof(esc),"\x1b[38;5;%dm",ci);
-                    ssize_t w5=write(STDOUT_FILENO,esc,n); (void)w5;
-                    color_on=1; last_ci=ci;
+            a->qci[(size_t)j*v.w+i] = ci;
+        }
+    }
+    emit_values(a,lv,a->qci,v.w,v.h,0);
+}
+
+// recompile the [complex] programs when their source changed
+static void app_cx_compile(App *a){
+    char src[sizeof(a->cx_src)];
+    snprintf(src,sizeof(src),"%s\n%s",a->cfg.cx_map,a->cfg.cx_z0);
+    if(!strcmp(src,a->cx_src)) return;
+    strcpy(a->cx_src,src);
+    char err[96];
+    a->cx_ok = 0; a->cx_valid = 0;
+    if(cx_compile(&a->cx.map,a->cfg.cx_map,err,sizeof(err)))
+        snprintf(a->cx_err,sizeof(a->cx_err),"map: %s",err);
+    else if(cx_compile(&a->cx.z0,a->cfg.cx_z0,err,sizeof(err)))
+        snprintf(a->cx_err,sizeof(a->cx_err),"z0: %s",err);
+    else { a->cx_ok = 1; a->cx_err[0] = 0; }
+}
+
+/* basin colors when no color palette is active */
+static const int BASIN_COLORS[] = { 196, 46, 33, 226, 201, 51, 208, 129 };
+#define BASIN_COLOR_COUNT (int)(sizeof(BASIN_COLORS)/sizeof(BASIN_COLORS[0]))
+
+/* complex_iter: converged cells are colored by the root they reached and
+   shaded by how fast they got there; escaped ones map like a fractal */
+static void render_complex(App *a, double t){
+    FracView v; app_frac_view(a,&v);
+    v.prec = FRAC_PREC_DOUBLE; v.ref = NULL;
+    if(v.w<=0 || v.h<=0 || app_grid_reserve(a,(size_t)v.w*v.h) || app_cx_reserve(a,(size_t)v.w*v.h)) return;
+    app_cx_compile(a);
+    const size_t n=(size_t)v.w*v.h;
+    a->frac_computed = 0;
+    if(!a->cx_ok){
+        const Glyph *g=&a->acs.g[cs_idx_from_value(&a->acs,-1.0)];
+        for(size_t k=0;k<n;k++) set_cell(a,&a->cells[k],g,-1);
+        app_emit(a,v.w,v.h);
+        return;
+    }
+    int uses_t = a->cx.map.uses_t || a->cx.z0.uses_t;
+    int dirty = !a->cx_valid || !frac_view_eq(&v,&a->cx_view) || (uses_t && t!=a->cx_t)
+             || a->cx.bailout!=a->cfg.cx_bailout || a->cx.converge!=a->cfg.cx_converge;
+    if(dirty){
+        a->cx.bailout = a->cfg.cx_bailout;
+        a->cx.converge = a->cfg.cx_converge;
+        cx_render(&v,&a->cx,t,a->pool,a->iters,a->cx_zr,a->cx_zi,a->cx_state);
+        a->cx_roots = cx_basins(&v,a->cx_zr,a->cx_zi,a->cx_state,fmax(1e-3,1e3*a->cx.converge),a->cx_basin);
+        a->cx_view=v; a->cx_t=t; a->cx_valid=1;
+        a->frac_computed = (long)n;
+    }
+    if(app_quant_reserve(a,n)) return;
+
+    const int max=v.max_iter;
+    const int pal = a->cur_col.valid && a->cur_col.count>0;
+    for(int j=0;j<v.h;j++){
+        for(int i=0;i<v.w;i++){
+            size_t k=(size_t)j*v.w+i;
+            int iter = a->iters[k];
+            int ci;
+            double tval;
+            if(a->cx_state[k]==CX_CONVERGED && a->cx_basin[k]>=0){
+                int b=a->cx_basin[k];
+                tval = 1.0 - 2.0*(double)iter/(double)max;
+                ci = pal ? a->cur_col.codes[b % a->cur_col.count] : BASIN_COLORS[b % BASIN_COLOR_COUNT];
+            }else{
+                tval = (a->cx_state[k]==CX_ESCAPED) ? (double)iter/(double)max*2.0-1.0 : -1.0;
+                if(a->cfg.color_func && pal) ci = a->cur_col.codes[(iter + (int)lrint(t*20.0)) % a->cur_col.count];
+                else {
+                    double x0,y0; frac_pixel(&v,i,j,&x0,&y0);
+                    ci = pixel_color_code(a,i,j,x0,y0,t);
                 }
+            }
+            a->qv[k]=(float)tval; a->qci[k]=ci;
+        }
+    }
+    emit_values(a,a->qv,a->qci,v.w,v.h,0);
+}
+
+/* buddhabrot: each frame adds samples to the density of the current view,
+   so a still view fills in; nebulabrot puts its three densities on the
+   red/green/blue axes of the 6x6x6 color cube */
+static void render_buddha(App *a, double t){
+    FracView v; app_frac_view(a,&v);
+    v.prec = FRAC_PREC_DOUBLE; v.ref = NULL; v.series = 0;
+    if(v.w<=0 || v.h<=0 || app_grid_reserve(a,(size_t)v.w*v.h)) return;
+    const int nebula = a->cfg.mode==MODE_NEBULABROT;
+    const size_t n=(size_t)v.w*v.h;
+    if(app_levels_reserve(a,3*n) || app_quant_reserve(a,n)) return;
+    if(buddha_reset(&a->buddha,&v,nebula,a->pool)) return;
+    buddha_step(&a->buddha,a->cfg.buddha_samples,a->pool);
+    a->frac_computed = a->cfg.buddha_samples;
+    for(int ch=0;ch<a->buddha.chans;ch++) buddha_levels(&a->buddha,ch,a->levels+ch*n);
+
+    const int pal = a->cur_col.valid && a->cur_col.count>0;
+    for(int j=0;j<v.h;j++){
+        for(int i=0;i<v.w;i++){
+            size_t k=(size_t)j*v.w+i;
+            double lv;
+            int ci;
+            if(nebula){
+                float r=a->levels[k], g=a->levels[n+k], b=a->levels[2*n+k];
+                lv = r>g ? (r>b ? r : b) : (g>b ? g : b);
+                ci = 16 + 36*(int)lrintf(r*5) + 6*(int)lrintf(g*5) + (int)lrintf(b*5);
             }else{
-                if(color_on){ append_str("\x1b[0m"); color_on=0; last_ci=-2; }
+                lv = a->levels[k];
+                if(pal) ci = CI_BY_VALUE;
+                else {
+                    double x0,y0; frac_pixel(&v,i,j,&x0,&y0);
+                    ci = pixel_color_code(a,i,j,x0,y0,t);
+                }
             }
-            emit_glyph(eg);
+            a->qv[k]=(float)(lv*2.0-1.0); a->qci[k]=ci;
+        }
+    }
+    emit_values(a,a->qv,a->qci,v.w,v.h,0);
+}
+
+/* lyapunov: one pass per view through the same iteration buffer and cache
+   as the escape-time modes. stable (negative) exponents are shaded by how
+   strongly they contract; chaotic ones get the bottom of the ramp */
+static void render_lyapunov(App *a, double t){
+    FracView v; app_frac_view(a,&v);
+    v.prec = FRAC_PREC_DOUBLE; v.ref = NULL; v.series = 0;
+    v.seq = a->cfg.lyap_seq; v.seq_len = a->cfg.lyap_seq_len;
+    if(v.w<=0 || v.h<=0 || app_grid_reserve(a,(size_t)v.w*v.h) || app_quant_reserve(a,(size_t)v.w*v.h)) return;
+    a->frac_cache.limit = (size_t)(a->cfg.frac_cache_mb>0 ? a->cfg.frac_cache_mb : 0) << 20;
+    a->frac_computed = 0;
+    if(!frac_view_eq(&v,&a->frac_view)){
+        if(!frac_cache_get(&a->frac_cache,&v,a->iters)){
+            lyap_render(&v,a->iters,a->pool);
+            frac_cache_put(&a->frac_cache,&v,a->iters);
+            a->frac_computed = (long)v.w*v.h;
         }
-        if(color_on) append_str("\x1b[0m");
+        a->frac_view=v; a->frac_step=1; a->frac_orbit_on=0;
     }
+
+    const int pal = a->cur_col.valid && a->cur_col.count>0;
+    for(int j=0;j<v.h;j++){
+        for(int i=0;i<v.w;i++){
+            size_t k=(size_t)j*v.w+i;
+            double lambda = a->iters[k]/(double)LYAP_SCALE;
+            double tval = lambda<0 ? 1.0 - 2.0*exp(lambda) : -1.0;
+            int ci;
+            if(a->cfg.color_func && pal) ci = CI_BY_VALUE;
+            else {
+                double x0,y0; frac_pixel(&v,i,j,&x0,&y0);
+                ci = pixel_color_code(a,i,j,x0,y0,t);
+            }
+            a->qv[k]=(float)tval; a->qci[k]=ci;
+        }
+    }
+    emit_values(a,a->qv,a->qci,v.w,v.h,0);
+}
+
+/* raymarch: diffuse shade of the sdf scene; a still scene (no t, no spin)
+   is marched once and only recolored after that */
+static void render_raymarch(App *a, double t){
+    const int w=a->tw, h=a->th - a->info_rows;
+    if(w<=0 || h<=0 || app_grid_reserve(a,(size_t)w*h) || app_levels_reserve(a,(size_t)w*h) || app_quant_reserve(a,(size_t)w*h)) return;
+    const size_t n=(size_t)w*h;
+    if(strcmp(a->cfg.ray_sdf,a->ray_src)){
+        strcpy(a->ray_src,a->cfg.ray_sdf);
+        char err[96];
+        a->ray_ok = !ray_compile(&a->ray_sdf,a->ray_src,err,sizeof(err));
+        if(a->ray_ok) a->ray_err[0]=0; else snprintf(a->ray_err,sizeof(a->ray_err),"sdf: %s",err);
+        a->ray_valid=0;
+    }
+    if(!a->ray_ok){
+        const Glyph *g=&a->acs.g[cs_idx_from_value(&a->acs,-1.0)];
+        for(size_t k=0;k<n;k++) set_cell(a,&a->cells[k],g,-1);
+        app_emit(a,w,h);
+        return;
+    }
+    const int animated = (a->ray_sdf.uses & 1u<<3) || a->cfg.ray.spin!=0;
+    if(!a->ray_valid || a->ray_w!=w || a->ray_h!=h || !ray_cam_eq(&a->ray_cam,&a->cfg.ray) || (animated && t!=a->ray_t)){
+        ray_render(&a->cfg.ray,&a->ray_sdf,t,w,h,a->levels,a->pool);
+        a->ray_cam=a->cfg.ray; a->ray_w=w; a->ray_h=h; a->ray_t=t; a->ray_valid=1;
+    }
+
+    const int pal = a->cur_col.valid && a->cur_col.count>0;
+    for(int j=0;j<h;j++){
+        for(int i=0;i<w;i++){
+            size_t k=(size_t)j*w+i;
+            float sh=a->levels[k];
+            // hits start a notch up the ramp so unlit surface still shows
+            double tval = sh<0 ? -1.0 : -1.0 + 2.0*(0.08 + 0.92*sh);
+            int ci;
+            if(a->cfg.color_func && pal) ci = CI_BY_VALUE;
+            else {
+                double x = (double)i/((w-1>0)?(w-1):1)*2.0 - 1.0;
+                double y = (double)j/((h-1>0)?(h-1):1)*2.0 - 1.0;
+                ci = pixel_color_code(a,i,j,x,y,t);
+            }
+            a->qv[k]=(float)tval; a->qci[k]=ci;
+        }
+    }
+    emit_values(a,a->qv,a->qci,w,h,0);
+}
+
+/* life/grayscott/heat: the grid is stepped at [sim] rate against t rather
+   than once per frame, so fps only changes how often it is looked at */
+static void render_sim(App *a, double t){
+    const int w=a->tw, h=a->th - a->info_rows;
+    if(w<=0 || h<=0 || app_grid_reserve(a,(size_t)w*h) || app_levels_reserve(a,(size_t)w*h) || app_quant_reserve(a,(size_t)w*h)) return;
+    const int scale = a->cfg.sim_scale<1 ? 1 : a->cfg.sim_scale>16 ? 16 : a->cfg.sim_scale;
+    SimParams p=a->cfg.sim;
+    p.kind = (SimKind)(a->cfg.mode - MODE_LIFE);
+    const int seeded = sim_reset(&a->sim,&p,w*scale,h*scale);
+    if(seeded<0) return;
+    if(seeded) a->sim_t0 = t;
+
+    long owed = a->cfg.sim_rate>0 ? (long)floor((t - a->sim_t0)*a->cfg.sim_rate) - a->sim.steps : 0;
+    if(owed<0) owed=0;
+    const int cap = a->cfg.sim_max_steps>0 ? a->cfg.sim_max_steps : 1;
+    if(owed>cap){
+        // fell behind: run what fits and let the clock slip instead of piling up
+        a->sim_t0 += (double)(owed-cap)/a->cfg.sim_rate;
+        owed=cap;
+    }
+    sim_step(&a->sim,(int)owed,a->pool);
+    a->sim_frame_steps=(int)owed;
+    sim_sample(&a->sim,w,h,scale,a->levels);
+
+    const int pal = a->cur_col.valid && a->cur_col.count>0;
+    for(int j=0;j<h;j++){
+        for(int i=0;i<w;i++){
+            size_t k=(size_t)j*w+i;
+            double tval = -1.0 + 2.0*a->levels[k];
+            int ci;
+            if(a->cfg.color_func && pal) ci = CI_BY_VALUE;
+            else {
+                double x = (double)i/((w-1>0)?(w-1):1)*2.0 - 1.0;
+                double y = (double)j/((h-1>0)?(h-1):1)*2.0 - 1.0;
+                ci = pixel_color_code(a,i,j,x,y,t);
+            }
+            a->qv[k]=(float)tval; a->qci[k]=ci;
+        }
+    }
+    emit_values(a,a->qv,a->qci,w,h,0);
+}
+
+static void app_render(App *a, double t){
+    const double c0=now_sec(), e0=g_stats.stage[STAGE_ENCODE];
+    // other renderers reuse levels, so the fractal's averaged frame goes stale
+    if(!mode_escape(a->cfg.mode)) a->aa_valid=0;
+    if(a->cfg.mode!=MODE_EXPR) a->tmp_valid=0;
+    if(a->cfg.mode==MODE_EXPR) render_expr(a, t);
+    else if(a->cfg.mode==MODE_COMPLEX) render_complex(a, t);
+    else if(a->cfg.mode==MODE_BUDDHABROT || a->cfg.mode==MODE_NEBULABROT) render_buddha(a, t);
+    else if(a->cfg.mode==MODE_LYAPUNOV) render_lyapunov(a, t);
+    else if(a->cfg.mode==MODE_RAYMARCH) render_raymarch(a, t);
+    else if(mode_sim(a->cfg.mode)) render_sim(a, t);
+    else render_fractal(a, t);
+    // compute is everything but emitting; expressions and grids evaluate, the rest iterate
+    const double c=now_sec()-c0-(g_stats.stage[STAGE_ENCODE]-e0);
+    const int eval = a->cfg.mode==MODE_EXPR || a->cfg.mode==MODE_RAYMARCH || mode_sim(a->cfg.mode);
+    stats_add(eval ? STAGE_EVAL : STAGE_ITERATE, c);
+}
+
+// everything a holds but the pool; layers go with it
+static void app_free(App *a){
+    for(int l=0;l<a->nlayers;l++){ app_free(a->layer[l]); free(a->layer[l]); }
+    a->nlayers=0;
+    free(a->cells); free(a->iters); free(a->iters_ref);
+    frac_ref_free(&a->frac_ref);
+    frac_orbit_free(&a->frac_orbit);
+    frac_cache_free(&a->frac_cache);
+    frac_eq_free(&a->frac_eq);
+    free(a->aa_mark); free(a->aa_ci); free(a->aa_samples);
+    free(a->qv); free(a->qci); free(a->qg); free(a->qc); dither_free(&a->dither);
+    free(a->tmp_v); free(a->tmp_ci); free(a->tmp_age);
+    free(a->expr_plan.data); free(a->color_plan.data);
+    path_ahead_stop(&a->ahead);
+    free(a->cx_zr); free(a->cx_zi); free(a->cx_state); free(a->cx_basin);
+    free(a->jz_re); free(a->jz_im);
+    buddha_free(&a->buddha); free(a->levels);
+    sim_free(&a->sim);
+}
+
+// a fresh App, as main() and each --bench run start from
+static void app_init(App *a){
+    memset(a,0,sizeof(*a));
+    set_defaults(&a->cfg);
+    a->info_mode = INFO_ALL;
+    a->info_rows = 0;
+    a->cached_col_idx = -9999;
+    a->cur_preset_idx = -1;
+    a->run_mode = RUNMODE_PLAYER;
+    a->editor_param = EP_FPS;
+    a->editor_step_idx = 2; /* step=1 */
+    a->editor_submode = ESM_DRAW;
+    a->live_preview = 1;
+    a->editing_text = 0; a->edit_buf[0]=0; a->edit_orig[0]=0; a->edit_len=0; a->edit_cursor=0; a->edit_target=EDIT_TARGET_EXPR;
+    a->editing_tokens = 0; a->expr_tok_count=0; a->expr_tok_sel=0; a->edit_tok_idx=-1; a->pending_brace=0;
+    editor_set_submode(a, ESM_DRAW);
 }
 
 // ----------------------------- IO/helpers ----------------------------------
@@ -1289,10 +2649,12 @@ static char *read_file(const char *path){
     if(fread(buf,1,sz,f)!=(size_t)sz){ fclose(f); free(buf); return NULL; }
     buf[sz]=0; fclose(f); return buf;
 }
+static void app_load_layers(App *a, const char *txt); // fwd
 static int load_config_from_text(App *a, const char *txt){
     Config c; set_defaults(&c);
-    parse_ini(&c, txt);
+    parse_ini(&c, txt, 0);
     a->cfg = c;
+    app_load_layers(a, txt);
     // (re)build derived state
     app_pick_charset(a);
     a->cached_col_idx = -9999; a->cur_col.valid = 0;
@@ -1310,6 +2672,38 @@ static int load_config_from_file(App *a, const char *path){
 static int save_function_to_file(const Config *c, const char *path){
     FILE *f=fopen(path,"wb"); if(!f) return -1;
     fprintf(f,"[expr]\nvalue=%s\ncolor=%s\n", c->expr_value, c->expr_color);
+    if(c->mode!=MODE_EXPR){
+        // enough digits to place the center within ~1e-20 of a cell at this zoom
+        int digits = (int)ceil(-log10(c->scale>0?c->scale:1.0)) + 24;
+        if(digits<17) digits=17;
+        char xs[200], ys[200];
+        mp_to_str(&c->hcx,xs,sizeof(xs),digits);
+        mp_to_str(&c->hcy,ys,sizeof(ys),digits);
+        fprintf(f,"\n[mode]\ntype=%s\n\n[fractal]\nmax_iter=%d\ncenter_x=%s\ncenter_y=%s\nscale=%.17g\nc_re=%.17g\nc_im=%.17g\n",
+            MODE_INFO[c->mode].name, c->max_iter, xs, ys, c->scale, c->j_re, c->j_im);
+        if(c->mode==MODE_MULTIBROT) fprintf(f,"power=%d\n",c->power);
+        if(c->julia_seed && mode_escape(c->mode) && c->mode!=MODE_MANDELBROT && c->mode!=MODE_JULIA) fprintf(f,"julia=1\n");
+        if(c->mode==MODE_BUDDHABROT || c->mode==MODE_NEBULABROT) fprintf(f,"samples=%d\n",c->buddha_samples);
+        if(c->mode==MODE_LYAPUNOV){
+            char seq[LYAP_MAX_SEQ+1]; lyap_seq_str(c->lyap_seq,c->lyap_seq_len,seq);
+            fprintf(f,"\n[lyapunov]\nsequence=%s\n",seq);
+        }
+        if(c->mode==MODE_RAYMARCH){
+            const RayCam *r=&c->ray;
+            fprintf(f,"\n[raymarch]\nsdf=%s\ncamera=%g %g %g\ntarget=%g %g %g\nlight=%g %g %g\nfov=%g\nspin=%g\nsteps=%d\nepsilon=%g\nmax_dist=%g\n",
+                c->ray_sdf, r->pos[0], r->pos[1], r->pos[2], r->target[0], r->target[1], r->target[2],
+                r->light[0], r->light[1], r->light[2], r->fov, r->spin, r->steps, r->eps, r->max_dist);
+        }
+        if(mode_sim(c->mode)){
+            char rule[20]; sim_rule_str(c->sim.birth,c->sim.survive,rule,sizeof(rule));
+            fprintf(f,"\n[sim]\nrule=%s\ndensity=%g\nfeed=%g\nkill=%g\ndu=%g\ndv=%g\nalpha=%g\ncool=%g\nseed=%u\nrate=%g\nmax_steps=%d\nscale=%d\n",
+                rule, c->sim.density, c->sim.feed, c->sim.kill, c->sim.du, c->sim.dv, c->sim.alpha, c->sim.cool,
+                c->sim.seed, c->sim_rate, c->sim_max_steps, c->sim_scale);
+        }
+        if(c->mode==MODE_COMPLEX)
+            fprintf(f,"\n[complex]\nmap=%s\nz0=%s\nbailout=%.17g\nconverge=%.17g\n",
+                c->cx_map, c->cx_z0, c->cx_bailout, c->cx_converge);
+    }
     fclose(f);
     return 0;
 }
@@ -1342,11 +2736,444 @@ static int find_color_index(const char *name){
         if(strieq(g_color_pals[i].name,name)) return (int)i;
     return -1;
 }
+// ----------------------------- layers --------------------------------------
+/* [layer.N] each become an App over the base config plus the layer's own
+   sections. a layer without char= / color= follows the base's palettes */
+static void app_load_layers(App *a, const char *txt){
+    for(int l=0;l<a->nlayers;l++){ app_free(a->layer[l]); free(a->layer[l]); }
+    a->nlayers=0;
+    for(int n=1;n<=LAYER_MAX;n++){
+        if(!(a->cfg.layer_mask & 1u<<n)) continue;
+        App *L=(App*)calloc(1,sizeof(App)); if(!L) break;
+        L->cfg=a->cfg; L->cfg.layer_mask=0;
+        parse_ini(&L->cfg,txt,n);
+        L->is_layer=1; L->run_mode=RUNMODE_PLAYER; L->cur_preset_idx=-1;
+        int ci=find_char_index(L->cfg.layer_char), co=find_color_index(L->cfg.layer_color);
+        if(ci>=0){
+            parse_char_palette_text(g_char_pals[ci].text,&L->acs);
+            if(!L->acs.name[0]) snprintf(L->acs.name,sizeof(L->acs.name),"%s",g_char_pals[ci].name);
+            L->own_cs=1;
+        }else if(strcmp(L->cfg.charset,a->cfg.charset)){ cs_from_string(&L->acs,L->cfg.charset,"cfg"); L->own_cs=1; }
+        if(co>=0){ colorpal_parse_from_text(g_color_pals[co].name,g_color_pals[co].text,&L->cur_col); L->own_col=1; }
+        bg_from_config(&L->bg,L->cfg.background_utf8);
+        a->layer[a->nlayers++]=L;
+    }
+}
+
+static const Glyph G_SPACE = { " ", 1, 1 };
+
+static int cell_blank(const Cell *c){ return c->g->is_space && c->bg<0; }
+
+/* bring L up to the base's terminal and palettes; 1 if its grid is stale */
+static int layer_sync(const App *a, App *L){
+    int stale = L->tw!=a->tw || L->th!=a->th || L->info_rows!=a->info_rows;
+    L->tw=a->tw; L->th=a->th; L->info_rows=a->info_rows;
+    L->t0=a->t0; L->pool=a->pool; L->paused=a->paused;
+    if(!L->own_cs && memcmp(&L->acs,&a->acs,sizeof(L->acs))){
+        L->acs=a->acs; L->shape_map.valid=0; L->tmp_valid=0; stale=1;
+    }
+    if(!L->own_col && memcmp(&L->cur_col,&a->cur_col,sizeof(L->cur_col))){
+        L->cur_col=a->cur_col; L->tmp_valid=L->aa_valid=0; stale=1;
+    }
+    return stale;
+}
+
+/* redraw the layers that are due, then stack their grids in order. a layer
+   is due on its rate=, after a resize or palette change, and every frame
+   while an escape-time view is still refining */
+static void render_layers(App *a, double t, int fps){
+    const int w=a->tw, h=a->th - a->info_rows;
+    const size_t n=(size_t)w*h;
+    if(w<=0 || h<=0 || app_grid_reserve(a,n)) return;
+    // the layers time their own renders; stacking them is encode time
+    const double c0=now_sec(), s0=stats_open();
+    for(size_t k=0;k<n;k++){ a->cells[k].g=&G_SPACE; a->cells[k].ci=-1; a->cells[k].bg=-1; }
+    for(int l=0;l<a->nlayers;l++){
+        App *L=a->layer[l];
+        const double rate=L->cfg.layer_rate;
+        int due = layer_sync(a,L) || L->drawn_w!=w || L->drawn_h!=h || rate<0
+               || (rate>0 && t-L->layer_t >= 1.0/rate)
+               || (mode_escape(L->cfg.mode) && L->frac_step!=1);
+        if(due){
+            app_path_step(L,t,fps);
+            app_render(L,t);
+            L->layer_t=t;
+        }
+        if(L->drawn_w!=w || L->drawn_h!=h) continue;
+        const int blend=L->cfg.layer_blend;
+        for(size_t k=0;k<n;k++){
+            const Cell *s=&L->cells[k];
+            Cell *d=&a->cells[k];
+            if(cell_blank(s)) continue;
+            if(blend==BLEND_OVER || (blend==BLEND_UNDER && cell_blank(d)) || (blend==BLEND_MASK && !cell_blank(d))) *d=*s;
+            else if(blend==BLEND_CUT){ d->g=&G_SPACE; d->ci=-1; d->bg=-1; }
+        }
+    }
+    // what no layer covers shows the base's background
+    for(size_t k=0;k<n;k++) if(cell_blank(&a->cells[k])) a->cells[k].g=&a->bg.bg;
+    stats_add(STAGE_ENCODE, now_sec()-c0-(stats_open()-s0));
+    emit_cells(a->cells,w,h);
+}
+
+// ---- --bench: headless runs at a fixed size on a synthetic clock ----------
+typedef struct {
+    int w, h, frames;
+    int mem;                  // sink: 1 = memory buffer, 0 = write(2) to /dev/null
+    int char_all, color_all;  // sweep every char / color palette
+    int repeat;               // runs of each, the fastest counts
+    const char *json;         // also write the results here ("-" = stdout only)
+    const char *baseline;     // perf gate: ns/cell per run, recorded if missing
+    double slack;             // gate: percent slower than the baseline allowed
+    int update;               // rewrite the baseline / golden files
+} BenchOpts;
+
+typedef struct {
+    char preset[128], chr[64], col[64];
+    double wall;                    // seconds for all frames
+    double stage[STAGE_COUNT];      // seconds per stage, all frames
+    unsigned long long bytes, writes;
+    int mode;
+} BenchRun;
+
+// ---- --check: golden frames --------------------------------------------------
+#define GOLDEN_W      64
+#define GOLDEN_H      20
+#define GOLDEN_FRAMES 6
+#define FNV_SEED      0xcbf29ce484222325ull
+
+typedef struct {
+    unsigned long long grid, stream;   // fnv-1a over every frame's cells / encoded bytes
+    char *glyphs[GOLDEN_FRAMES], *colors[GOLDEN_FRAMES];   // each frame, a line per row
+} Golden;
+
+static unsigned long long fnv1a(unsigned long long h, const void *p, size_t n){
+    const unsigned char *b=(const unsigned char*)p;
+    for(size_t k=0;k<n;k++){ h^=b[k]; h*=0x100000001b3ull; }
+    return h;
+}
+
+static void golden_cells(Golden *g, const App *a, int w, int h, int f);
+
+// needs the memory sink, cleared at the start of the frame
+static void golden_frame(Golden *g, const App *a, int w, int h, int f){
+    if(!a->cells) return;
+    if(f<GOLDEN_FRAMES) golden_cells(g,a,w,h,f);
+    for(size_t k=0;k<(size_t)w*h;k++){
+        const Cell *c=&a->cells[k];
+        const int col[2]={ c->ci, c->bg };
+        g->grid=fnv1a(g->grid,c->g->glyph,c->g->glen);
+        g->grid=fnv1a(g->grid,col,sizeof(col));
+    }
+    size_t n; const char *m=term_mem(&n);
+    g->stream=fnv1a(g->stream,m,n);
+}
+
+// colors: "-" for none, else ci or ci/bg, space separated
+static void golden_cells(Golden *g, const App *a, int w, int h, int f){
+    size_t gl=(size_t)h+1;
+    for(size_t k=0;k<(size_t)w*h;k++) gl+=a->cells[k].g->glen;
+    g->glyphs[f]=(char*)malloc(gl);
+    g->colors[f]=(char*)malloc((size_t)w*h*24+(size_t)h+1);
+    if(!g->glyphs[f] || !g->colors[f]) return;
+    char *p=g->glyphs[f], *q=g->colors[f];
+    for(int j=0;j<h;j++){
+        for(int i=0;i<w;i++){
+            const Cell *c=&a->cells[(size_t)j*w+i];
+            memcpy(p,c->g->glyph,c->g->glen); p+=c->g->glen;
+            if(i) *q++=' ';
+            if(c->bg>=0) q+=sprintf(q,"%d/%d",c->ci,c->bg);
+            else if(c->ci>=0) q+=sprintf(q,"%d",c->ci);
+            else *q++='-';
+        }
+        *p++='\n'; *q++='\n';
+    }
+    *p=0; *q=0;
+}
+
+/* one config (a file, or baked preset idx) with the palettes selected now:
+   o->frames frames at t = frame/fps, each emitted to the sink; g, when
+   given, gets the golden hashes and every frame's cells */
+static int bench_one(const BenchOpts *o, const char *path, int preset, BenchRun *r, Golden *g){
+    App app; app_init(&app);
+    app.info_mode = INFO_NONE;
+    g_headless_w = o->w; g_headless_h = o->h;
+    if(path ? load_config_from_file(&app,path) : load_baked_preset_by_index(&app,preset)){ app_free(&app); return -1; }
+    if(g) app.cfg.path.lookahead = 0;   // prerendered frames land when they are ready, so never the same twice
+    colorpal_from_selection(&app.cur_col);
+    app.cached_col_idx = g_colorpal_idx;
+    app.pool = pool_create(app.cfg.threads);
+    frac_set_pool(app.pool);
+    const int fps = app.cfg.fps<=0?30:app.cfg.fps;
+    stats_reset();
+    const TermOut out0 = g_term_out;
+    const double w0 = now_sec();
+    for(int f=0;f<o->frames;f++){
+        const double t = (double)f/fps;
+        stats_frame_begin();
+        if(o->mem) term_mem_clear();
+        app_query_size(&app);
+        update_info_rows(&app);
+        stats_lap(STAGE_INPUT, g_stats.begin);
+        if(app.nlayers) render_layers(&app, t, fps);
+        else{
+            app_path_step(&app, t, fps);
+            app_render(&app, t);
+        }
+        if(g) golden_frame(g, &app, app.tw, app.th-app.info_rows, f);
+        const double l=now_sec(); term_flush(); stats_lap(STAGE_WRITE,l);
+        stats_frame_end(g_term_out.bytes, g_term_out.writes);
+    }
+    r->wall = now_sec() - w0;
+    r->mode = app.cfg.mode;
+    memcpy(r->stage, g_stats.total, sizeof(r->stage));
+    r->bytes = g_term_out.bytes - out0.bytes;
+    r->writes = g_term_out.writes - out0.writes;
+    snprintf(r->preset,sizeof(r->preset),"%s", path ? path : g_baked_presets[preset].name);
+    snprintf(r->chr,sizeof(r->chr),"%s", g_charpal_idx>=0 ? g_char_pals[g_charpal_idx].name : "-");
+    snprintf(r->col,sizeof(r->col),"%s", g_colorpal_idx>=0 ? g_color_pals[g_colorpal_idx].name : "-");
+    app_free(&app);
+    frac_set_pool(NULL);
+    pool_destroy(app.pool);
+    return 0;
+}
+
+static double bench_ns(const BenchOpts *o, const BenchRun *r){ return r->wall/o->frames/((double)o->w*o->h)*1e9; }
+
+static void bench_print(FILE *f, const BenchOpts *o, const BenchRun *r){
+    const double n=o->frames, ms=1e3/n;
+    fprintf(f,"%-20s %-14s %-18s %8.1f %8.1f %10.0f %9.0f %8.2f %8.2f %8.2f %8.2f\n",
+        r->preset, r->chr, r->col, n/r->wall, bench_ns(o,r),
+        r->bytes/n, r->writes/n, r->stage[STAGE_EVAL]*ms, r->stage[STAGE_ITERATE]*ms, r->stage[STAGE_ENCODE]*ms, r->stage[STAGE_WRITE]*ms);
+    fflush(f);
+}
+
+static void bench_json(FILE *f, const BenchOpts *o, const BenchRun *runs, int n){
+    const double fr=o->frames, ms=1e3/fr;
+    fprintf(f,"{\"width\":%d,\"height\":%d,\"frames\":%d,\"sink\":\"%s\",\"runs\":[\n",o->w,o->h,o->frames,o->mem?"mem":"null");
+    for(int k=0;k<n;k++){
+        const BenchRun *r=&runs[k];
+        fprintf(f," {\"preset\":\"%s\",\"char\":\"%s\",\"color\":\"%s\",\"fps\":%.2f,\"ns_per_cell\":%.2f,"
+                  "\"bytes_per_frame\":%.0f,\"writes_per_frame\":%.0f,"
+                  "\"ms_per_frame\":{\"eval\":%.4f,\"iterate\":%.4f,\"encode\":%.4f,\"write\":%.4f}}%s\n",
+            r->preset, r->chr, r->col, fr/r->wall, bench_ns(o,r),
+            r->bytes/fr, r->writes/fr, r->stage[STAGE_EVAL]*ms, r->stage[STAGE_ITERATE]*ms, r->stage[STAGE_ENCODE]*ms, r->stage[STAGE_WRITE]*ms,
+            k+1<n?",":"");
+    }
+    fprintf(f,"]}\n");
+}
+
+/* the perf gate: a run fails when its ns/cell is more than slack percent
+   over the baseline's for the same preset and palettes, or when the
+   baseline lacks it. --update records the baseline from these runs */
+static int bench_gate(const BenchOpts *o, const BenchRun *runs, int n){
+    char *txt = o->update ? NULL : read_file(o->baseline);
+    if(!txt && !o->update){
+        fprintf(stderr,"perf: no baseline %s, nothing checked (record one with --update)\n", o->baseline);
+        return 1;
+    }
+    if(!txt){
+        FILE *f=fopen(o->baseline,"w");
+        if(!f){ fprintf(stderr,"perf: cannot write %s\n", o->baseline); return 1; }
+        fprintf(f,"# asciiviz perf baseline, %dx%d, %d frames: preset char color ns/cell\n", o->w, o->h, o->frames);
+        for(int k=0;k<n;k++) fprintf(f,"%s %s %s %.2f\n", runs[k].preset, runs[k].chr, runs[k].col, bench_ns(o,&runs[k]));
+        fclose(f);
+        fprintf(stderr,"perf: baseline recorded in %s\n", o->baseline);
+        return 0;
+    }
+    int seen=0, bad=0, missing=0;
+    for(int k=0;k<n;k++){
+        const BenchRun *r=&runs[k];
+        char key[320]; snprintf(key,sizeof(key),"%s %s %s ", r->preset, r->chr, r->col);
+        const size_t kl=strlen(key);
+        double base=-1;
+        for(const char *l=txt; *l; ){
+            if(!strncmp(l,key,kl)){ base=atof(l+kl); break; }
+            const char *e=strchr(l,'\n'); if(!e) break;
+            l=e+1;
+        }
+        if(base<=0){ fprintf(stderr,"perf: %s %s %s: not in the baseline\n", r->preset, r->chr, r->col); missing++; continue; }
+        seen++;
+        const double ns=bench_ns(o,r);
+        if(ns > base*(1+o->slack/100)){
+            fprintf(stderr,"perf: %s %s %s: %.1f ns/cell, baseline %.1f (+%.0f%%)\n", r->preset, r->chr, r->col, ns, base, (ns/base-1)*100);
+            bad++;
+        }
+    }
+    fprintf(stderr,"perf: %d of %d runs within %.0f%% of %s\n", seen-bad, seen+missing, o->slack, o->baseline);
+    free(txt);
+    return bad>0 || missing>0;
+}
+
+/* the config, the preset, or every baked preset; each with the palettes
+   chosen (or its own), then with every char and/or color palette in turn.
+   sweeping both is one axis at a time, not the full cross product */
+static int bench_main(const BenchOpts *o, const char *path, const char *preset){
+    int first=0, last=0;
+    if(!path){
+        if(preset){ first=find_preset_index(preset); if(first<0){ fprintf(stderr,"Preset not found: %s\n", preset); return 1; } last=first+1; }
+        else last=(int)g_baked_presets_count;
+        if(first>=last){ fprintf(stderr,"bench: no presets\n"); return 1; }
+    }
+    const int chr0=g_charpal_idx, col0=g_colorpal_idx;
+    const int per = 1 + (o->char_all ? (int)g_char_pals_count : 0) + (o->color_all ? (int)g_color_pals_count : 0);
+    const int total = (path ? 1 : last-first) * per;
+    BenchRun *runs = (BenchRun*)calloc((size_t)total, sizeof(BenchRun));
+    if(!runs) return 1;
+    FILE *txt = (o->json && !strcmp(o->json,"-")) ? stderr : stdout;
+    fprintf(txt,"%dx%d, %d frames, %s sink; times are ms/frame\n", o->w, o->h, o->frames, o->mem?"mem":"null");
+    fprintf(txt,"%-20s %-14s %-18s %8s %8s %10s %9s %8s %8s %8s %8s\n",
+        "preset","char","color","fps","ns/cell","bytes/fr","writes/fr","eval","iterate","encode","write");
+    int n=0, rc=0;
+    for(int p=first; p<(path ? first+1 : last); p++){
+        for(int k=0;k<per;k++){
+            int chr=chr0, col=col0, q=k-1;   // run 0: as chosen, then the sweeps
+            if(q>=0 && o->char_all){ if(q<(int)g_char_pals_count){ chr=q; q=-1; } else q-=(int)g_char_pals_count; }
+            if(q>=0) col=q;
+            g_charpal_idx=chr; g_colorpal_idx=col;
+            if(bench_one(o,path,p,&runs[n],NULL)){ fprintf(stderr,"bench: cannot load %s\n", path ? path : g_baked_presets[p].name); rc=1; continue; }
+            for(int rep=1;rep<o->repeat;rep++){
+                BenchRun again;
+                if(!bench_one(o,path,p,&again,NULL) && again.wall<runs[n].wall) runs[n]=again;
+            }
+            bench_print(txt,o,&runs[n]);
+            n++;
+        }
+    }
+    if(o->json){
+        FILE *f = strcmp(o->json,"-") ? fopen(o->json,"w") : stdout;
+        if(!f){ fprintf(stderr,"bench: cannot write %s\n", o->json); rc=1; }
+        else{ bench_json(f,o,runs,n); if(f!=stdout) fclose(f); }
+    }
+    if(o->baseline && bench_gate(o,runs,n)) rc=1;
+    free(runs);
+    return rc;
+}
+
+/* cells of any one frame that may differ when the hashes don't match.
+   built as the Makefile does (-std=c99 keeps fp contraction off) -O0,
+   -O2 and -O3 -march=native all match exactly; what is left is another
+   libm's last ulp, so one coarse 4x4 block. contracting into fma moves up
+   to 144 escape-time cells a frame, and fails */
+#define GOLDEN_ALLOW 16
+static int golden_allow(int mode){
+    return mode==MODE_LIFE ? 0 : GOLDEN_ALLOW;   // life is integer: exact
+}
+
+/* cut last-frame text into w*h cells: a code point each for glyphs, space
+   separated tokens for colors; cells a row lacks stay empty */
+static void golden_split(const char *s, int tokens, int w, int h, const char **at, int *len){
+    for(size_t k=0;k<(size_t)w*h;k++){ at[k]=""; len[k]=0; }
+    for(int j=0;j<h && *s;j++){
+        for(int i=0; *s && *s!='\n'; i++){
+            const char *b=s;
+            if(tokens) while(*s && *s!=' ' && *s!='\n') s++;
+            else for(int m=utf8_len((unsigned char)*s); m>0 && *s && *s!='\n'; m--) s++;
+            if(i<w){ at[(size_t)j*w+i]=b; len[(size_t)j*w+i]=(int)(s-b); }
+            if(tokens && *s==' ') s++;
+        }
+        if(*s=='\n') s++;
+    }
+}
+
+static int golden_diff(const char *ga, const char *gb, const char *ca, const char *cb, int w, int h){
+    const size_t n=(size_t)w*h;
+    const char **at=(const char**)malloc(4*n*sizeof(*at));
+    int *len=(int*)malloc(4*n*sizeof(int));
+    if(!at || !len){ free(at); free(len); return w*h; }
+    golden_split(ga,0,w,h,at,len);     golden_split(gb,0,w,h,at+n,len+n);
+    golden_split(ca,1,w,h,at+2*n,len+2*n); golden_split(cb,1,w,h,at+3*n,len+3*n);
+    int d=0;
+    for(size_t k=0;k<n;k++)
+        d += len[k]!=len[n+k] || memcmp(at[k],at[n+k],len[k]) || len[2*n+k]!=len[3*n+k] || memcmp(at[2*n+k],at[3*n+k],len[2*n+k]);
+    free(at); free(len);
+    return d;
+}
+
+// frame f's glyph and color rows in a golden file, NULL if it has none
+static int golden_find(const char *txt, int f, const char **gl, const char **co){
+    char mark[40]; snprintf(mark,sizeof(mark),"\nframe %d\nglyphs\n",f);
+    const char *s=strstr(txt,mark);
+    if(!s) return -1;
+    *gl=s+strlen(mark);
+    s=strstr(*gl,"\ncolors\n");
+    if(!s) return -1;
+    *co=s+8;
+    return 0;
+}
+
+// 0: identical, 1: within the mode's tolerance, -1: failed (and said why)
+static int golden_compare(const char *name, const char *path, const Golden *g, int mode){
+    char *txt=read_file(path);
+    if(!txt){ printf("%-20s FAIL: no %s\n", name, path); return -1; }
+    int w=0, h=0, fr=0, rc=-1;
+    unsigned long long grid=0, stream=0;
+    if(sscanf(txt,"asciiviz golden 2\nsize %dx%d frames %d\ngrid %llx\nstream %llx",&w,&h,&fr,&grid,&stream)!=5
+       || w!=GOLDEN_W || h!=GOLDEN_H || fr!=GOLDEN_FRAMES)
+        printf("%-20s FAIL: %s is not a golden file for this build\n", name, path);
+    else if(grid==g->grid && stream==g->stream){ printf("%-20s ok\n", name); rc=0; }
+    else if(grid==g->grid) printf("%-20s FAIL: same cells, different encoded bytes\n", name);
+    else{
+        const int allow=golden_allow(mode);
+        int worst=-1, at=0;
+        for(int f=0;f<fr;f++){
+            const char *gl, *co;
+            const int d = golden_find(txt,f,&gl,&co) ? w*h : golden_diff(gl,g->glyphs[f],co,g->colors[f],w,h);
+            if(d>worst){ worst=d; at=f; }
+        }
+        if(worst<=allow) rc=1;
+        printf("%-20s %s: %d cells differ in frame %d, %d allowed\n", name, rc>0 ? "ok" : "FAIL", worst, at, allow);
+    }
+    free(txt);
+    return rc;
+}
+
+/* every baked preset (the cfgs in functions/) at a fixed size, frame count and
+   clock, against dir/NAME.golden; update writes those files instead */
+static int check_main(const char *dir, int update){
+    const BenchOpts o={ .w=GOLDEN_W, .h=GOLDEN_H, .frames=GOLDEN_FRAMES, .mem=1 };
+    int exact=0, approx=0, fail=0;
+    if(!g_baked_presets_count){ fprintf(stderr,"check: no presets\n"); return 1; }
+    double log_err;
+    const int off=lyap_check(&log_err);
+    if(off>1 || log_err>1e-12){ printf("%-20s FAIL: %d/%d off a per-step log(), lane log %.2g\n", "lyapunov kernel", off, LYAP_SCALE, log_err); fail++; }
+    else printf("%-20s ok (%d/%d off a per-step log(), lane log %.2g)\n", "lyapunov kernel", off, LYAP_SCALE, log_err);
+    for(size_t p=0;p<g_baked_presets_count;p++){
+        const char *name=g_baked_presets[p].name;
+        Golden g={ .grid=FNV_SEED, .stream=FNV_SEED };
+        BenchRun r;
+        char path[1024]; snprintf(path,sizeof(path),"%s/%s.golden",dir,name);
+        g_charpal_idx=-1; g_colorpal_idx=-1;
+        int ok = !bench_one(&o,NULL,(int)p,&r,&g);
+        for(int f=0;f<GOLDEN_FRAMES;f++) ok = ok && g.glyphs[f] && g.colors[f];
+        if(!ok){ printf("%-20s FAIL: cannot render\n", name); fail++; }
+        else if(update){
+            FILE *f=fopen(path,"w");
+            if(!f){ printf("%-20s FAIL: cannot write %s\n", name, path); fail++; }
+            else{
+                fprintf(f,"asciiviz golden 2\nsize %dx%d frames %d\ngrid %016llx\nstream %016llx\n", o.w, o.h, o.frames, g.grid, g.stream);
+                for(int k=0;k<GOLDEN_FRAMES;k++) fprintf(f,"frame %d\nglyphs\n%scolors\n%s", k, g.glyphs[k], g.colors[k]);
+                fclose(f);
+                printf("%-20s written\n", name); exact++;
+            }
+        }else{
+            const int c=golden_compare(name,path,&g,r.mode);
+            if(c==0) exact++; else if(c>0) approx++; else fail++;
+        }
+        fflush(stdout);
+        for(int f=0;f<GOLDEN_FRAMES;f++){ free(g.glyphs[f]); free(g.colors[f]); }
+    }
+    printf("check: %d exact, %d within tolerance, %d failed\n", exact, approx, fail);
+    return fail>0;
+}
+
 static void usage(const char *argv0){
     fprintf(stderr,
-"Usage: %s [--config file] [--preset NAME] [--char NAME] [--color NAME] [--background UTF8] [--color-func]\n"
+"Usage: %s [--config file] [--preset NAME] [--char NAME] [--color NAME] [--background UTF8] [--color-func] [--stats-file FILE]\n"
+"       %s --bench [--size WxH] [--frames N] [--sink null|mem] [--json FILE|-] [--config file | --preset NAME] [--char NAME|all] [--color NAME|all]\n"
+"                [--repeat N] [--baseline FILE [--slack PCT] [--update]]\n"
+"       %s --check DIR [--update]\n"
 "Keys: q quit | p pause | i info | W whitespace-transparency | w cycle background | +/- fps | C toggle color | c next color | f col-math | n next char | m next function | r reload | arrows/[] pan/zoom\n",
-    argv0);
+    argv0, argv0, argv0);
     if(g_baked_presets_count){
         fprintf(stderr,"Functions:"); for(size_t i=0;i<g_baked_presets_count;i++) fprintf(stderr," %s", g_baked_presets[i].name); fprintf(stderr,"\n");
     }
@@ -1360,26 +3187,17 @@ static void usage(const char *argv0){
 
 // ----------------------------- main ----------------------------------------
 int main(int argc, char **argv){
-    App app; memset(&app,0,sizeof(app));
-    set_defaults(&app.cfg);
-    app.info_mode = INFO_ALL;
-    app.info_rows = 0;
-    app.cached_col_idx = -9999;
-    app.cur_preset_idx = -1;
-    app.run_mode = RUNMODE_PLAYER;
-    app.editor_param = EP_FPS;
-    app.editor_step_idx = 2; /* step=1 */
-    app.editor_submode = ESM_DRAW;
-    app.live_preview = 1;
-    app.editing_text = 0; app.edit_buf[0]=0; app.edit_orig[0]=0; app.edit_len=0; app.edit_cursor=0; app.edit_target=EDIT_TARGET_EXPR;
-    app.editing_tokens = 0; app.expr_tok_count=0; app.expr_tok_sel=0; app.edit_tok_idx=-1; app.pending_brace=0;
-    editor_set_submode(&app, ESM_DRAW);
+    App app; app_init(&app);
 
     const char *config_path = NULL;
     const char *preset = NULL;
     const char *char_name = NULL;
     const char *color_name = NULL;
     const char *background_arg = NULL;
+    const char *check_dir = NULL;
+    const char *stats_path = NULL;
+    int bench = 0;
+    BenchOpts bo = { .w=240, .h=70, .frames=100, .repeat=1, .slack=25 };
 
     for(int i=1;i<argc;i++){
         if(!strcmp(argv[i],"-c")||!strcmp(argv[i],"--config")){
@@ -1394,6 +3212,28 @@ int main(int argc, char **argv){
             if(i+1<argc){ background_arg=argv[++i]; } else { usage(argv[0]); return 1; }
         } else if(!strcmp(argv[i],"--color-func")){
             app.cfg.color_func = 1;
+        } else if(!strcmp(argv[i],"--stats-file")){
+            if(i+1<argc){ stats_path=argv[++i]; } else { usage(argv[0]); return 1; }
+        } else if(!strcmp(argv[i],"--bench")){
+            bench = 1;
+        } else if(!strcmp(argv[i],"--size")){
+            if(i+1<argc && sscanf(argv[++i],"%dx%d",&bo.w,&bo.h)==2 && bo.w>0 && bo.h>0){ } else { usage(argv[0]); return 1; }
+        } else if(!strcmp(argv[i],"--frames")){
+            if(i+1<argc && (bo.frames=atoi(argv[++i]))>0){ } else { usage(argv[0]); return 1; }
+        } else if(!strcmp(argv[i],"--sink")){
+            if(i+1<argc && (!strcmp(argv[i+1],"null") || !strcmp(argv[i+1],"mem"))){ bo.mem = !strcmp(argv[++i],"mem"); } else { usage(argv[0]); return 1; }
+        } else if(!strcmp(argv[i],"--json")){
+            if(i+1<argc){ bo.json=argv[++i]; } else { usage(argv[0]); return 1; }
+        } else if(!strcmp(argv[i],"--repeat")){
+            if(i+1<argc && (bo.repeat=atoi(argv[++i]))>0){ } else { usage(argv[0]); return 1; }
+        } else if(!strcmp(argv[i],"--baseline")){
+            if(i+1<argc){ bo.baseline=argv[++i]; } else { usage(argv[0]); return 1; }
+        } else if(!strcmp(argv[i],"--slack")){
+            if(i+1<argc && (bo.slack=atof(argv[++i]))>=0){ } else { usage(argv[0]); return 1; }
+        } else if(!strcmp(argv[i],"--check")){
+            if(i+1<argc){ check_dir=argv[++i]; } else { usage(argv[0]); return 1; }
+        } else if(!strcmp(argv[i],"--update")){
+            bo.update = 1;
         } else if(!strcmp(argv[i],"-h")||!strcmp(argv[i],"--help")){
             usage(argv[0]); return 0;
         } else {
@@ -1401,6 +3241,22 @@ int main(int argc, char **argv){
         }
     }
 
+    if(bench || check_dir){
+        if(check_dir) bo.mem = 1;
+        if(char_name && !strcmp(char_name,"all")){ bo.char_all=1; char_name=NULL; }
+        if(color_name && !strcmp(color_name,"all")){ bo.color_all=1; color_name=NULL; }
+        if(char_name && (g_charpal_idx=find_char_index(char_name))<0){ fprintf(stderr,"Char palette not found: %s\n", char_name); return 1; }
+        if(color_name && (g_colorpal_idx=find_color_index(color_name))<0){ fprintf(stderr,"Color palette not found: %s\n", color_name); return 1; }
+        int fd = -1;
+        if(!bo.mem && (fd=open("/dev/null",O_WRONLY))<0){ perror("/dev/null"); return 1; }
+        term_sink_fd(fd);
+        g_headless=1;
+        subcell_tables_init();
+        int rc = check_dir ? check_main(check_dir, bo.update) : bench_main(&bo, config_path, preset);
+        if(fd>=0) close(fd);
+        return rc;
+    }
+
     // load function/preset/config
     if(config_path){
         if(load_config_from_file(&app, config_path)!=0){
@@ -1438,7 +3294,16 @@ int main(int argc, char **argv){
 
     colorpal_from_selection(&app.cur_col);
 
+    // threads= is read once; reloading a config keeps the pool it started with
+    app.pool = pool_create(app.cfg.threads);
+    frac_set_pool(app.pool);
+    subcell_tables_init();
+
+    FILE *stats_log = NULL;
+    if(stats_path && !(stats_log=stats_log_open(stats_path))){ fprintf(stderr,"Cannot write stats file: %s\n", stats_path); return 1; }
+
     signal(SIGWINCH,on_winch);
+    atexit(term_flush);   // registered first, so it runs after the restores below
     term_raw_on(); atexit(term_raw_off);
     term_alt_on(); atexit(term_alt_off);
     term_wrap_off(); atexit(term_wrap_on);
@@ -1450,12 +3315,15 @@ int main(int argc, char **argv){
     app.t0 = start;
 
     for(;;){
+        stats_frame_begin();
+        double lap = g_stats.begin;
         if(g_resized){ g_resized=0; app_query_size(&app); term_clear(); }
         app_query_size(&app);
 
         if(app.cached_col_idx != g_colorpal_idx){
             colorpal_from_selection(&app.cur_col);
             app.cached_col_idx = g_colorpal_idx;
+            app.tmp_valid = app.aa_valid = 0;
         }
 
         int fps = app.cfg.fps<=0?30:app.cfg.fps;
@@ -1492,19 +3360,19 @@ int main(int argc, char **argv){
                 else if(c==0x1b){
                     if(k+2<n && keys[k+1]=='['){
                         char d=keys[k+2];
-                        if(app.cfg.mode==MODE_MANDELBROT || app.cfg.mode==MODE_JULIA){
+                        if(app.cfg.mode!=MODE_EXPR){
                             double pan = app.cfg.scale*0.05;
-                            if(d=='A') app.cfg.cy -= pan;
-                            if(d=='B') app.cfg.cy += pan;
-                            if(d=='C') app.cfg.cx += pan;
-                            if(d=='D') app.cfg.cx -= pan;
+                            if(d=='A') app_pan(&app,0,-pan);
+                            if(d=='B') app_pan(&app,0,pan);
+                            if(d=='C') app_pan(&app,pan,0);
+                            if(d=='D') app_pan(&app,-pan,0);
                         }
                         k+=2;
                     }
                 } else if(c=='[' || c==']'){
-                    if(app.cfg.mode==MODE_MANDELBROT || app.cfg.mode==MODE_JULIA){
-                        if(c==']') app.cfg.scale *= 0.9;
-                        else app.cfg.scale *= 1.1;
+                    if(app.cfg.mode!=MODE_EXPR){
+                        if(c==']'){ if(app.cfg.scale*0.9 >= FRAC_DEEP_MIN_SCALE) app.cfg.scale *= 0.9; }
+                        else app.cfg.scale /= 0.9;   // exact inverse, so zooming back hits the cache
                     }
                 }
             }else{ /* editor mode */
@@ -1630,16 +3498,34 @@ int main(int argc, char **argv){
             }
         }
         update_info_rows(&app);
-        // draw
-        if(app.cfg.mode==MODE_EXPR) render_expr(&app, t);
-        else if(app.cfg.mode==MODE_MANDELBROT) render_mandel(&app);
-        else render_julia(&app);
+        lap = stats_lap(STAGE_INPUT, lap);
+        if(app.nlayers) render_layers(&app, t, fps);
+        else{
+            app_path_step(&app, t, fps);
+            app_render(&app, t);
+        }
+        lap = now_sec();   // the path step and renders timed themselves, compositing included
 
         draw_info_bar(&app);
+        lap = stats_lap(STAGE_ENCODE, lap);
+        term_flush();
+        lap = stats_lap(STAGE_WRITE, lap);
         msleep(frame_ms);
+        stats_lap(STAGE_SLEEP, lap);
+        stats_frame_end(g_term_out.bytes, g_term_out.writes);
+        if(stats_log) stats_log_frame(stats_log, t);
     }
 
 out:
+    if(stats_log) fclose(stats_log);
     term_clear();
+    if(app.frac_checked_frames){
+        term_alt_off();
+        term_flush();
+        fprintf(stderr,"validate: %ld of %ld subdiv frames differed from brute force (last: %ld cells)\n",
+            app.frac_bad_frames, app.frac_checked_frames, app.frac_mismatch);
+    }
+    app_free(&app);
+    pool_destroy(app.pool);
     return 0;
 }
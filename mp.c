@@ -0,0 +1,166 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+#include "mp.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static int mag_is_zero(const uint32_t *a){
+    for(int k=0;k<MP_LIMBS;k++) if(a[k]) return 0;
+    return 1;
+}
+static int mag_cmp(const uint32_t *a, const uint32_t *b){
+    for(int k=0;k<MP_LIMBS;k++) if(a[k]!=b[k]) return a[k]<b[k] ? -1 : 1;
+    return 0;
+}
+static void mag_add(uint32_t *r, const uint32_t *a, const uint32_t *b){
+    uint64_t carry=0;
+    for(int k=MP_LIMBS-1;k>=0;k--){
+        uint64_t s=(uint64_t)a[k]+b[k]+carry;
+        r[k]=(uint32_t)s; carry=s>>32;
+    }
+}
+static void mag_sub(uint32_t *r, const uint32_t *a, const uint32_t *b){   // |a| >= |b|
+    int64_t borrow=0;
+    for(int k=MP_LIMBS-1;k>=0;k--){
+        int64_t s=(int64_t)a[k]-b[k]-borrow;
+        borrow = s<0;
+        r[k]=(uint32_t)(s + (borrow ? ((int64_t)1<<32) : 0));
+    }
+}
+// divide magnitude by a small integer in place, most significant limb first
+static void mag_div_small(uint32_t *a, uint32_t div){
+    uint64_t rem=0;
+    for(int k=0;k<MP_LIMBS;k++){
+        uint64_t cur=(rem<<32)|a[k];
+        a[k]=(uint32_t)(cur/div); rem=cur%div;
+    }
+}
+// multiply the fractional part by a small integer; returns what spills into the integer limb
+static uint32_t frac_mul_small(uint32_t *a, uint32_t mul){
+    uint64_t carry=0;
+    for(int k=MP_LIMBS-1;k>=1;k--){
+        uint64_t cur=(uint64_t)a[k]*mul+carry;
+        a[k]=(uint32_t)cur; carry=cur>>32;
+    }
+    return (uint32_t)carry;
+}
+
+void mp_zero(Mp *r){ memset(r,0,sizeof(*r)); }
+
+int mp_eq(const Mp *a, const Mp *b){ return a->neg==b->neg && mag_cmp(a->d,b->d)==0; }
+
+void mp_from_double(Mp *r, double x){
+    mp_zero(r);
+    if(!isfinite(x)) return;
+    r->neg = x<0; x=fabs(x);
+    double ip=floor(x);
+    r->d[0] = ip>=4294967295.0 ? 0xffffffffu : (uint32_t)ip;
+    double f=x-ip;
+    for(int k=1;k<MP_LIMBS && f>0;k++){
+        f*=4294967296.0;
+        double l=floor(f);
+        r->d[k]=(uint32_t)l; f-=l;
+    }
+    if(mag_is_zero(r->d)) r->neg=0;
+}
+
+double mp_to_double(const Mp *a){
+    double v=0, w=1.0;
+    for(int k=0;k<MP_LIMBS;k++){ v += a->d[k]*w; w /= 4294967296.0; }
+    return a->neg ? -v : v;
+}
+
+int mp_from_str(Mp *r, const char *s){
+    mp_zero(r);
+    char dig[160]; int nd=0, point=-1, any=0;
+    while(*s==' '||*s=='\t') s++;
+    int neg=0;
+    if(*s=='-'){ neg=1; s++; } else if(*s=='+') s++;
+    for(;;s++){
+        if(*s>='0' && *s<='9'){ if(nd<(int)sizeof(dig)) dig[nd++]=*s; any=1; }
+        else if(*s=='.' && point<0) point=nd;
+        else break;
+    }
+    if(!any) return 0;
+    if(point<0) point=nd;
+    if(*s=='e' || *s=='E'){
+        int e=0, eneg=0; s++;
+        if(*s=='-'){ eneg=1; s++; } else if(*s=='+') s++;
+        while(*s>='0' && *s<='9'){ if(e<10000) e=e*10+(*s-'0'); s++; }
+        point += eneg ? -e : e;
+    }
+    // integer digits are dig[0..point-1]; anything left of dig[0] is a zero
+    uint64_t ip=0;
+    for(int k=0;k<point && k<nd;k++){ ip=ip*10+(uint64_t)(dig[k]-'0'); if(ip>0xffffffffu) ip=0xffffffffu; }
+    for(int k=nd;k<point;k++){ ip*=10; if(ip>0xffffffffu) ip=0xffffffffu; }
+    // fraction: f = (digit + f)/10, from the last digit back to the point
+    for(int k=nd-1;k>=(point>0?point:0);k--){ r->d[0]=(uint32_t)(dig[k]-'0'); mag_div_small(r->d,10); }
+    for(int k=point;k<0;k++){ r->d[0]=0; mag_div_small(r->d,10); }   // zeros right after the point
+    r->d[0]=(uint32_t)ip;
+    r->neg = neg && !mag_is_zero(r->d);
+    return 1;
+}
+
+void mp_to_str(const Mp *a, char *out, size_t outsz, int digits){
+    if(!outsz) return;
+    uint32_t f[MP_LIMBS];
+    memcpy(f,a->d,sizeof(f));
+    char dig[200];
+    if(digits>(int)sizeof(dig)-1) digits=(int)sizeof(dig)-1;
+    if(digits<0) digits=0;
+    for(int k=0;k<=digits;k++) dig[k]=(char)frac_mul_small(f,10);
+    uint64_t ip=a->d[0];
+    if(dig[digits]>=5){   // round half up, carrying into the integer part if needed
+        int k=digits-1;
+        while(k>=0 && dig[k]==9) dig[k--]=0;
+        if(k>=0) dig[k]++; else ip++;
+    }
+    while(digits>1 && dig[digits-1]==0) digits--;
+    int n=snprintf(out,outsz,"%s%llu", a->neg?"-":"", (unsigned long long)ip);
+    size_t pos = n>0 ? (size_t)n : 0;
+    if(digits<=0 || pos+2>=outsz) return;
+    out[pos++]='.';
+    for(int k=0;k<digits && pos+1<outsz;k++) out[pos++]=(char)('0'+dig[k]);
+    out[pos]=0;
+}
+
+void mp_add(Mp *r, const Mp *a, const Mp *b){
+    Mp t;
+    if(a->neg==b->neg){ mag_add(t.d,a->d,b->d); t.neg=a->neg; }
+    else if(mag_cmp(a->d,b->d)>=0){ mag_sub(t.d,a->d,b->d); t.neg=a->neg; }
+    else { mag_sub(t.d,b->d,a->d); t.neg=b->neg; }
+    if(mag_is_zero(t.d)) t.neg=0;
+    *r=t;
+}
+
+void mp_sub(Mp *r, const Mp *a, const Mp *b){
+    Mp nb=*b;
+    nb.neg = !nb.neg && !mag_is_zero(nb.d);
+    mp_add(r,a,&nb);
+}
+
+void mp_mul(Mp *r, const Mp *a, const Mp *b){
+    // schoolbook product of the limb strings; the binary point sits after limb 0
+    // of each factor, so the result is limbs 1..MP_LIMBS of the 2*MP_LIMBS product
+    uint32_t p[2*MP_LIMBS];
+    memset(p,0,sizeof(p));
+    for(int i=MP_LIMBS-1;i>=0;i--){
+        if(!a->d[i]) continue;
+        uint64_t carry=0;
+        for(int j=MP_LIMBS-1;j>=0;j--){
+            uint64_t cur=(uint64_t)a->d[i]*b->d[j] + p[i+j+1] + carry;
+            p[i+j+1]=(uint32_t)cur; carry=cur>>32;
+        }
+        p[i]+=(uint32_t)carry;
+    }
+    Mp t;
+    memcpy(t.d,p+1,sizeof(t.d));
+    t.neg = (a->neg!=b->neg) && !mag_is_zero(t.d);
+    *r=t;
+}
+
+void mp_add_double(Mp *r, double x){
+    Mp t; mp_from_double(&t,x);
+    mp_add(r,r,&t);
+}
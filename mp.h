@@ -0,0 +1,26 @@
+#ifndef MP_H
+#define MP_H
+#include <stddef.h>
+#include <stdint.h>
+
+/* signed fixed-point number: d[0] is the integer part, d[1..] are 32-bit
+   fractional limbs, most significant first (~86 decimal digits) */
+#define MP_LIMBS 10
+
+typedef struct {
+    int      neg;
+    uint32_t d[MP_LIMBS];
+} Mp;
+
+void   mp_zero(Mp *r);
+void   mp_from_double(Mp *r, double x);
+double mp_to_double(const Mp *a);
+int    mp_from_str(Mp *r, const char *s);               // decimal, optional e-exponent; 0 on junk
+void   mp_to_str(const Mp *a, char *out, size_t outsz, int digits);
+int    mp_eq(const Mp *a, const Mp *b);
+
+void   mp_add(Mp *r, const Mp *a, const Mp *b);
+void   mp_sub(Mp *r, const Mp *a, const Mp *b);
+void   mp_mul(Mp *r, const Mp *a, const Mp *b);
+void   mp_add_double(Mp *r, double x);
+#endif
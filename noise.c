@@ -0,0 +1,199 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+#include "noise.h"
+#include "vec.h"
+#include <math.h>
+#include <string.h>
+
+#define NOISE_LIMIT 1e15   // past this the lattice has no fraction left: 0
+
+// perlin's reference permutation of 0..255
+static const unsigned char P[256] = {
+    151,160,137, 91, 90, 15,131, 13,201, 95, 96, 53,194,233,  7,225,140, 36,103, 30, 69,142,  8, 99, 37,240, 21, 10, 23,190,  6,148,
+    247,120,234, 75,  0, 26,197, 62, 94,252,219,203,117, 35, 11, 32, 57,177, 33, 88,237,149, 56, 87,174, 20,125,136,171,168, 68,175,
+     74,165, 71,134,139, 48, 27,166, 77,146,158,231, 83,111,229,122, 60,211,133,230,220,105, 92, 41, 55, 46,245, 40,244,102,143, 54,
+     65, 25, 63,161,  1,216, 80, 73,209, 76,132,187,208, 89, 18,169,200,196,135,130,116,188,159, 86,164,100,109,198,173,186,  3, 64,
+     52,217,226,250,124,123,  5,202, 38,147,118,126,255, 82, 85,212,207,206, 59,227, 47, 16, 58, 17,182,189, 28, 42,223,183,170,213,
+    119,248,152,  2, 44,154,163, 70,221,153,101,155,167, 43,172,  9,129, 22, 39,253, 19, 98,108,110, 79,113,224,232,178,185,112,104,
+    218,246, 97,228,251, 34,242,193,238,210,144, 12,191,179,162,241, 81, 51,145,235,249, 14,239,107, 49,192,214, 31,181,199,106,157,
+    184, 84,204,176,115,121, 50, 45,127,  4,150,254,138,236,205, 93,222,114, 67, 29, 24, 72,243,141,128,195, 78, 66,215, 61,156,180,
+};
+
+// 3d: the twelve cube edge directions, padded to 16; 2d: eight compass directions
+static const double G3[16][3] = {
+    { 1, 1, 0 }, { -1, 1, 0 }, { 1,-1, 0 }, { -1,-1, 0 }, { 1, 0, 1 }, { -1, 0, 1 }, { 1, 0,-1 }, { -1, 0,-1 },
+    { 0, 1, 1 }, {  0,-1, 1 }, { 0, 1,-1 }, {  0,-1,-1 }, { 1, 1, 0 }, {  0,-1, 1 }, {-1, 1, 0 }, {  0,-1,-1 },
+};
+static const double G2[8][2] = {
+    { 1, 1 }, { -1, 1 }, { 1,-1 }, { -1,-1 }, { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0,-1 },
+};
+
+// octave offsets, so the octaves' lattices don't all meet at the origin
+static const double FBM_SHIFT[NOISE_MAX_OCTAVES] = { 0, 19.19, 47.47, 73.73, 101.01, 131.31, 163.63, 197.97 };
+
+static inline int hash2(long long x, long long y){ return P[(P[x & 255] + (y & 255)) & 255]; }
+static inline int hash3(long long x, long long y, long long z){ return P[(hash2(x,y) + (z & 255)) & 255]; }
+static inline double lerp(double t, double a, double b){ return a + t*(b-a); }
+#define FADE(t) ((t)*(t)*(t)*((t)*((t)*6 - 15) + 10))
+
+/* both versions take the corners in the same order and round the same way:
+   corner c is (i,j,k) = (c&1, c>>1&1, c>>2), lerped along x, then y, then z */
+double noise3(double x, double y, double z){
+    if(!(fabs(x)<NOISE_LIMIT && fabs(y)<NOISE_LIMIT && fabs(z)<NOISE_LIMIT)) return 0;
+    const double fx=floor(x), fy=floor(y), fz=floor(z);
+    const long long X=(long long)fx, Y=(long long)fy, Z=(long long)fz;
+    x-=fx; y-=fy; z-=fz;
+    double d[8];
+    for(int c=0;c<8;c++){
+        const int i=c&1, j=c>>1&1, k=c>>2;
+        const double *g=G3[hash3(X+i,Y+j,Z+k) & 15];
+        d[c] = g[0]*(x-i) + g[1]*(y-j) + g[2]*(z-k);
+    }
+    const double u=FADE(x), v=FADE(y), w=FADE(z);
+    return lerp(w, lerp(v, lerp(u,d[0],d[1]), lerp(u,d[2],d[3])),
+                   lerp(v, lerp(u,d[4],d[5]), lerp(u,d[6],d[7])));
+}
+
+double noise2(double x, double y){
+    if(!(fabs(x)<NOISE_LIMIT && fabs(y)<NOISE_LIMIT)) return 0;
+    const double fx=floor(x), fy=floor(y);
+    const long long X=(long long)fx, Y=(long long)fy;
+    x-=fx; y-=fy;
+    double d[4];
+    for(int c=0;c<4;c++){
+        const int i=c&1, j=c>>1;
+        const double *g=G2[hash2(X+i,Y+j) & 7];
+        d[c] = g[0]*(x-i) + g[1]*(y-j);
+    }
+    const double u=FADE(x), v=FADE(y);
+    return lerp(v, lerp(u,d[0],d[1]), lerp(u,d[2],d[3]));
+}
+
+static int fbm_octaves(double o){
+    if(!(o>=1)) return 1;
+    return o>=NOISE_MAX_OCTAVES ? NOISE_MAX_OCTAVES : (int)o;
+}
+
+double noise_fbm(double x, double y, double z, double octaves){
+    const int n=fbm_octaves(octaves);
+    double sum=0, norm=0, amp=1, f=1;
+    for(int o=0;o<n;o++){
+        const double s=FBM_SHIFT[o];
+        sum += amp*noise3(x*f+s, y*f+s, z*f+s);
+        norm += amp;
+        amp*=0.5; f*=2;
+    }
+    return sum/norm;
+}
+
+/* batches: lattice cells and hashes per lane, the fractions, fades, gradient
+   dots and lerps NOISE_LANES at a time */
+#if defined(__GNUC__)
+#define NOISE_LANES (FRAC_VEC_BYTES/8)
+
+static inline vf64 vld(const double *p){ vf64 v; memcpy(&v,p,sizeof(v)); return v; }
+static inline vf64 vlerp(vf64 t, vf64 a, vf64 b){ return a + t*(b-a); }
+
+// exact for |x| < 2^52, which NOISE_LIMIT keeps us under
+static inline vf64 vfloor(vf64 x){
+    const vf64 t=__builtin_convertvector(__builtin_convertvector(x,vi64),vf64);
+    return t + __builtin_convertvector(x<t,vf64);   // -1 where truncation went up
+}
+
+static int lanes_in_range(const double *x, const double *y, const double *z){
+    for(int k=0;k<NOISE_LANES;k++)
+        if(!(fabs(x[k])<NOISE_LIMIT && fabs(y[k])<NOISE_LIMIT && (!z || fabs(z[k])<NOISE_LIMIT))) return 0;
+    return 1;
+}
+
+static void noise3_lanes(const double *px, const double *py, const double *pz, double *out){
+    vf64 x=vld(px), y=vld(py), z=vld(pz);
+    const vf64 fx=vfloor(x), fy=vfloor(y), fz=vfloor(z);
+    const vi64 X=__builtin_convertvector(fx,vi64), Y=__builtin_convertvector(fy,vi64), Z=__builtin_convertvector(fz,vi64);
+    x-=fx; y-=fy; z-=fz;
+    vf64 d[8];
+    for(int c=0;c<8;c++){
+        const int i=c&1, j=c>>1&1, k=c>>2;
+        vf64 gx, gy, gz;
+        for(int l=0;l<NOISE_LANES;l++){
+            const double *g=G3[hash3(X[l]+i,Y[l]+j,Z[l]+k) & 15];
+            gx[l]=g[0]; gy[l]=g[1]; gz[l]=g[2];
+        }
+        d[c] = gx*(x-i) + gy*(y-j) + gz*(z-k);
+    }
+    const vf64 u=FADE(x), v=FADE(y), w=FADE(z);
+    const vf64 r = vlerp(w, vlerp(v, vlerp(u,d[0],d[1]), vlerp(u,d[2],d[3])),
+                            vlerp(v, vlerp(u,d[4],d[5]), vlerp(u,d[6],d[7])));
+    memcpy(out,&r,sizeof(r));
+}
+
+static void noise2_lanes(const double *px, const double *py, double *out){
+    vf64 x=vld(px), y=vld(py);
+    const vf64 fx=vfloor(x), fy=vfloor(y);
+    const vi64 X=__builtin_convertvector(fx,vi64), Y=__builtin_convertvector(fy,vi64);
+    x-=fx; y-=fy;
+    vf64 d[4];
+    for(int c=0;c<4;c++){
+        const int i=c&1, j=c>>1;
+        vf64 gx, gy;
+        for(int l=0;l<NOISE_LANES;l++){
+            const double *g=G2[hash2(X[l]+i,Y[l]+j) & 7];
+            gx[l]=g[0]; gy[l]=g[1];
+        }
+        d[c] = gx*(x-i) + gy*(y-j);
+    }
+    const vf64 u=FADE(x), v=FADE(y);
+    const vf64 r = vlerp(v, vlerp(u,d[0],d[1]), vlerp(u,d[2],d[3]));
+    memcpy(out,&r,sizeof(r));
+}
+
+void noise3_batch(int n, const double *x, const double *y, const double *z, double *out){
+    int k=0;
+    for(;k+NOISE_LANES<=n;k+=NOISE_LANES){
+        if(lanes_in_range(x+k,y+k,z+k)) noise3_lanes(x+k,y+k,z+k,out+k);
+        else for(int l=k;l<k+NOISE_LANES;l++) out[l]=noise3(x[l],y[l],z[l]);
+    }
+    for(;k<n;k++) out[k]=noise3(x[k],y[k],z[k]);
+}
+
+void noise2_batch(int n, const double *x, const double *y, double *out){
+    int k=0;
+    for(;k+NOISE_LANES<=n;k+=NOISE_LANES){
+        if(lanes_in_range(x+k,y+k,NULL)) noise2_lanes(x+k,y+k,out+k);
+        else for(int l=k;l<k+NOISE_LANES;l++) out[l]=noise2(x[l],y[l]);
+    }
+    for(;k<n;k++) out[k]=noise2(x[k],y[k]);
+}
+#else
+void noise3_batch(int n, const double *x, const double *y, const double *z, double *out){
+    for(int k=0;k<n;k++) out[k]=noise3(x[k],y[k],z[k]);
+}
+void noise2_batch(int n, const double *x, const double *y, double *out){
+    for(int k=0;k<n;k++) out[k]=noise2(x[k],y[k]);
+}
+#endif
+
+#define FBM_CHUNK 64
+
+void noise_fbm_batch(int n, const double *x, const double *y, const double *z, const double *octaves, double *out){
+    double sx[FBM_CHUNK], sy[FBM_CHUNK], sz[FBM_CHUNK], nz[FBM_CHUNK], sum[FBM_CHUNK], norm[FBM_CHUNK];
+    int oct[FBM_CHUNK];
+    for(int k0=0;k0<n;k0+=FBM_CHUNK){
+        const int m = n-k0<FBM_CHUNK ? n-k0 : FBM_CHUNK;
+        int most=1;
+        for(int k=0;k<m;k++){
+            oct[k]=fbm_octaves(octaves[k0+k]);
+            if(oct[k]>most) most=oct[k];
+            sum[k]=0; norm[k]=0;
+        }
+        double amp=1, f=1;
+        for(int o=0;o<most;o++){
+            const double s=FBM_SHIFT[o];
+            for(int k=0;k<m;k++){ sx[k]=x[k0+k]*f+s; sy[k]=y[k0+k]*f+s; sz[k]=z[k0+k]*f+s; }
+            noise3_batch(m,sx,sy,sz,nz);
+            for(int k=0;k<m;k++) if(o<oct[k]){ sum[k] += amp*nz[k]; norm[k] += amp; }
+            amp*=0.5; f*=2;
+        }
+        for(int k=0;k<m;k++) out[k0+k]=sum[k]/norm[k];
+    }
+}
@@ -0,0 +1,20 @@
+#ifndef NOISE_H
+#define NOISE_H
+
+/* gradient noise for expressions (perlin's improved noise): a fixed
+   permutation and gradient table, so every run and every thread sees the
+   same field. values lie in about -1..1, and are 0 on the integer lattice.
+   the batch versions give the same bits as the scalar ones, lane for lane;
+   out may be one of the inputs */
+#define NOISE_MAX_OCTAVES 8
+
+double noise2(double x, double y);
+double noise3(double x, double y, double z);
+/* octaves (1..NOISE_MAX_OCTAVES) of noise3, each at twice the frequency and
+   half the amplitude of the one before, scaled back to about -1..1 */
+double noise_fbm(double x, double y, double z, double octaves);
+
+void noise2_batch(int n, const double *x, const double *y, double *out);
+void noise3_batch(int n, const double *x, const double *y, const double *z, double *out);
+void noise_fbm_batch(int n, const double *x, const double *y, const double *z, const double *octaves, double *out);
+#endif
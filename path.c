@@ -0,0 +1,195 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+#include "path.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+int path_add_key(Path *p, const char *spec, const PathKey *prev){
+    if(p->n>=PATH_MAX_KEYS) return 0;
+    char buf[512], *save=NULL, *tok[7];
+    int nt=0;
+    strncpy(buf,spec,sizeof(buf)-1); buf[sizeof(buf)-1]=0;
+    for(char *s=strtok_r(buf," \t,",&save); s && nt<7; s=strtok_r(NULL," \t,",&save)) tok[nt++]=s;
+    if(nt<4) return 0;
+    PathKey k=*prev;
+    k.t=atof(tok[0]);
+    if(!mp_from_str(&k.cx,tok[1]) || !mp_from_str(&k.cy,tok[2])) return 0;
+    k.scale=atof(tok[3]);
+    if(!(k.scale>0)) return 0;
+    if(nt>=6){ k.j_re=atof(tok[4]); k.j_im=atof(tok[5]); }
+    if(nt>=7){
+        long it=atol(tok[6]);
+        k.max_iter = it<1 ? 1 : it>FRAC_MAX_ITER ? FRAC_MAX_ITER : (int)it;
+    }
+    int i=p->n++;
+    while(i>0 && p->key[i-1].t>k.t){ p->key[i]=p->key[i-1]; i--; }
+    p->key[i]=k;
+    return 1;
+}
+
+double path_length(const Path *p){
+    return p->n ? p->key[p->n-1].t : 0;
+}
+
+int path_eval(const Path *p, double t, PathKey *out){
+    if(p->n==0) return 0;
+    const PathKey *a=&p->key[0], *z=&p->key[p->n-1];
+    double len=z->t - a->t;
+    if(p->loop && len>0 && t>a->t) t = a->t + fmod(t - a->t, len);
+    if(t<=a->t){ *out=*a; return 1; }
+    if(t>=z->t){ *out=*z; return p->loop || t==z->t; }
+    int k=0;
+    while(p->key[k+1].t<=t) k++;
+    const PathKey *k0=&p->key[k], *k1=&p->key[k+1];
+    double u = (t - k0->t)/(k1->t - k0->t);
+    if(p->smooth) u = u*u*(3-2*u);
+
+    // scale moves geometrically; the center follows the scale so a zoom
+    // toward a point keeps that point still on screen
+    double s = k0->scale*pow(k1->scale/k0->scale,u);
+    double w = fabs(k1->scale-k0->scale) > 1e-9*k0->scale ? (k0->scale-s)/(k0->scale-k1->scale) : u;
+    Mp d, wm;
+    mp_from_double(&wm,w);
+    *out=*k0;
+    mp_sub(&d,&k1->cx,&k0->cx); mp_mul(&d,&d,&wm); mp_add(&out->cx,&k0->cx,&d);
+    mp_sub(&d,&k1->cy,&k0->cy); mp_mul(&d,&d,&wm); mp_add(&out->cy,&k0->cy,&d);
+    out->t=t;
+    out->scale=s;
+    out->j_re = k0->j_re + (k1->j_re-k0->j_re)*u;
+    out->j_im = k0->j_im + (k1->j_im-k0->j_im)*u;
+    out->max_iter = (int)lrint(k0->max_iter + (double)(k1->max_iter-k0->max_iter)*u);
+    return 1;
+}
+
+// same view app_frac_view() builds once the camera is on k
+void path_view(const PathKey *k, const PathTarget *tg, FracView *v){
+    memset(v,0,sizeof(*v));
+    v->w = tg->w;
+    v->h = tg->h;
+    frac_view_set_center(v,&k->cx,&k->cy);
+    v->scale = k->scale;
+    v->formula = tg->formula;
+    v->power = tg->power;
+    v->julia = tg->julia;
+    v->j_re = k->j_re; v->j_im = k->j_im;
+    v->max_iter = k->max_iter;
+    v->smooth = tg->smooth;
+    v->prec = frac_pick_prec(v,tg->prec);
+    v->series = tg->series;
+}
+
+// ---- lookahead worker -------------------------------------------------------
+static void *ahead_main(void *arg){
+    PathAhead *a=(PathAhead*)arg;
+    pthread_mutex_lock(&a->mu);
+    while(!a->quit){
+        // the first frame after the one on screen that the ring lacks
+        PathSlot *s=NULL; int f=-1;
+        int end = (int)ceil(path_length(&a->path)*a->tgt.fps);
+        for(int k=1;k<=a->nslot && a->tgt.w>0 && a->tgt.h>0;k++){
+            int fr=a->cur+k;
+            if(fr<0) continue;
+            if(!a->path.loop && fr>end) break;
+            if(a->slot[fr % a->nslot].frame==fr) continue;
+            s=&a->slot[fr % a->nslot]; f=fr;
+            break;
+        }
+        if(!s){ pthread_cond_wait(&a->cv,&a->mu); continue; }
+        s->frame=f; s->ready=0;
+        unsigned gen=a->gen;
+        PathTarget tg=a->tgt;
+        a->snap=a->path;
+        pthread_mutex_unlock(&a->mu);
+
+        PathKey key; path_eval(&a->snap,(double)f/tg.fps,&key);
+        FracView v; path_view(&key,&tg,&v);
+        size_t n=(size_t)v.w*v.h;
+        int ok=1;
+        if(s->cap<n){
+            int *it=(int*)realloc(s->iters,n*sizeof(int));
+            if(it){ s->iters=it; s->cap=n; } else ok=0;
+        }
+        if(ok && v.prec==FRAC_PREC_PERTURB){
+            v.ref=&s->ref;
+            if(frac_ref_prepare(&s->ref,&v)){ v.prec=FRAC_PREC_DOUBLE; v.ref=NULL; }
+        }
+        if(ok){
+            if(tg.method==FRAC_SUBDIV) frac_render_subdiv(&v,s->iters);
+            else frac_render_brute(&v,s->iters);
+        }
+
+        pthread_mutex_lock(&a->mu);
+        if(gen!=a->gen) s->frame=-1;
+        else if(ok){ s->v=v; s->ready=1; }   // a failed frame keeps its claim and is rendered on screen instead
+    }
+    pthread_mutex_unlock(&a->mu);
+    return NULL;
+}
+
+int path_ahead_sync(PathAhead *a, const Path *p, const PathTarget *tg, int frame){
+    if(a->started && a->nslot!=p->lookahead) path_ahead_stop(a);
+    if(p->lookahead<=0) return 0;
+    if(!a->started){
+        a->slot=(PathSlot*)calloc((size_t)p->lookahead,sizeof(PathSlot));
+        if(!a->slot) return -1;
+        a->nslot=p->lookahead;
+        for(int k=0;k<a->nslot;k++) a->slot[k].frame=-1;
+        a->path=*p; a->tgt=*tg; a->cur=frame; a->quit=0; a->gen=0;
+        pthread_mutex_init(&a->mu,NULL);
+        pthread_cond_init(&a->cv,NULL);
+        if(pthread_create(&a->th,NULL,ahead_main,a)){
+            pthread_mutex_destroy(&a->mu); pthread_cond_destroy(&a->cv);
+            free(a->slot); a->slot=NULL; a->nslot=0;
+            return -1;
+        }
+        a->started=1;
+        return 0;
+    }
+    pthread_mutex_lock(&a->mu);
+    if(memcmp(&a->path,p,sizeof(*p)) || memcmp(&a->tgt,tg,sizeof(*tg))){
+        a->path=*p; a->tgt=*tg; a->gen++;
+        for(int k=0;k<a->nslot;k++){ a->slot[k].frame=-1; a->slot[k].ready=0; }
+        pthread_cond_signal(&a->cv);
+    }
+    if(frame!=a->cur){ a->cur=frame; pthread_cond_signal(&a->cv); }
+    pthread_mutex_unlock(&a->mu);
+    return 0;
+}
+
+int path_ahead_take(PathAhead *a, int frame, const FracView *v, int *iters){
+    if(!a->started || frame<0) return 0;
+    int hit=0;
+    pthread_mutex_lock(&a->mu);
+    PathSlot *s=&a->slot[frame % a->nslot];
+    if(s->frame==frame && s->ready && frac_view_eq(&s->v,v)){
+        memcpy(iters,s->iters,(size_t)v->w*v->h*sizeof(int));
+        hit=1;
+    }
+    if(hit) a->hits++; else a->misses++;
+    pthread_mutex_unlock(&a->mu);
+    return hit;
+}
+
+int path_ahead_ready(PathAhead *a){
+    if(!a->started) return 0;
+    int n=0;
+    pthread_mutex_lock(&a->mu);
+    for(int k=0;k<a->nslot;k++) if(a->slot[k].ready && a->slot[k].frame>a->cur) n++;
+    pthread_mutex_unlock(&a->mu);
+    return n;
+}
+
+void path_ahead_stop(PathAhead *a){
+    if(!a->started) return;
+    pthread_mutex_lock(&a->mu);
+    a->quit=1;
+    pthread_cond_signal(&a->cv);
+    pthread_mutex_unlock(&a->mu);
+    pthread_join(a->th,NULL);
+    for(int k=0;k<a->nslot;k++){ free(a->slot[k].iters); frac_ref_free(&a->slot[k].ref); }
+    free(a->slot); a->slot=NULL; a->nslot=0;
+    pthread_mutex_destroy(&a->mu);
+    pthread_cond_destroy(&a->cv);
+    a->started=0;
+}
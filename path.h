@@ -0,0 +1,73 @@
+#ifndef PATH_H
+#define PATH_H
+#include <pthread.h>
+#include "fractal.h"
+
+/* keyframed camera path: [path] key=t center_x center_y scale [c_re c_im [max_iter]] */
+#define PATH_MAX_KEYS 64
+
+typedef struct {
+    double t;
+    Mp     cx, cy;
+    double scale;
+    double j_re, j_im;
+    int    max_iter;
+} PathKey;
+
+typedef struct {
+    PathKey key[PATH_MAX_KEYS];   // sorted by t
+    int     n;
+    int     smooth;      // ease in/out between keys instead of linear
+    int     loop;        // restart after the last key
+    int     lookahead;   // frames prerendered ahead of the display (0 = off)
+} Path;
+
+/* parse one key line; missing trailing fields repeat *prev. 0 on junk/full */
+int    path_add_key(Path *p, const char *spec, const PathKey *prev);
+double path_length(const Path *p);
+/* camera at time t; returns 0 (and the last key) once a non-looping path ended */
+int    path_eval(const Path *p, double t, PathKey *out);
+
+/* what the lookahead renders for: everything of a FracView not on the path */
+typedef struct {
+    int        w, h, julia, series, smooth, fps;
+    FracFormula formula;
+    int        power;
+    FracPrec   prec;     // requested tier; AUTO is picked per frame
+    FracMethod method;
+} PathTarget;
+
+typedef struct {
+    int      frame;      // frame index held (-1 = none)
+    int      ready;
+    FracView v;
+    int     *iters;
+    size_t   cap;
+    FracRef  ref;
+} PathSlot;
+
+/* background renderer filling a ring with the frames after the one shown */
+typedef struct {
+    pthread_t       th;
+    pthread_mutex_t mu;
+    pthread_cond_t  cv;
+    int             started, quit;
+    Path            path;
+    Path            snap;   // the worker's copy of path, taken under mu
+    PathTarget      tgt;
+    unsigned        gen;    // bumped when path/target change; stale work is dropped
+    int             cur;    // frame on screen
+    PathSlot       *slot;
+    int             nslot;
+    long            hits, misses;
+} PathAhead;
+
+void path_view(const PathKey *k, const PathTarget *tg, FracView *v);
+/* frame is on screen; hand the worker the current path/target (the ring
+   restarts if they changed). starts the worker on first use, -1 on failure */
+int  path_ahead_sync(PathAhead *a, const Path *p, const PathTarget *tg, int frame);
+/* copy frame's buffer if it was prerendered for exactly v */
+int  path_ahead_take(PathAhead *a, int frame, const FracView *v, int *iters);
+int  path_ahead_ready(PathAhead *a);   // frames waiting in the ring
+void path_ahead_stop(PathAhead *a);
+#endif
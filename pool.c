@@ -0,0 +1,97 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+#include "pool.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+struct Pool {
+    pthread_mutex_t mu;
+    pthread_cond_t  go, done;
+    pthread_t      *th;
+    int             n;          // worker threads; the submitting thread is one more
+    int             busy, quit;
+    unsigned        gen;        // bumped per loop so sleeping workers notice it
+    PoolFn          fn;
+    void           *ctx;
+    int             ntasks, next;
+    int             active;     // workers still inside the current loop
+};
+
+static void run_tasks(Pool *p){
+    for(;;){
+        pthread_mutex_lock(&p->mu);
+        int k = p->next<p->ntasks ? p->next++ : -1;
+        pthread_mutex_unlock(&p->mu);
+        if(k<0) return;
+        p->fn(p->ctx,k);
+    }
+}
+
+static void *worker(void *arg){
+    Pool *p=(Pool*)arg;
+    unsigned seen=0;
+    pthread_mutex_lock(&p->mu);
+    while(!p->quit){
+        if(p->gen==seen){ pthread_cond_wait(&p->go,&p->mu); continue; }
+        seen=p->gen;
+        pthread_mutex_unlock(&p->mu);
+        run_tasks(p);
+        pthread_mutex_lock(&p->mu);
+        if(--p->active==0) pthread_cond_signal(&p->done);
+    }
+    pthread_mutex_unlock(&p->mu);
+    return NULL;
+}
+
+Pool *pool_create(int threads){
+    if(threads<=0){ long n=sysconf(_SC_NPROCESSORS_ONLN); threads = n>0 ? (int)n : 1; }
+    if(threads<=1) return NULL;
+    Pool *p=(Pool*)calloc(1,sizeof(Pool)); if(!p) return NULL;
+    p->th=(pthread_t*)calloc((size_t)threads-1,sizeof(pthread_t));
+    if(!p->th){ free(p); return NULL; }
+    pthread_mutex_init(&p->mu,NULL);
+    pthread_cond_init(&p->go,NULL);
+    pthread_cond_init(&p->done,NULL);
+    for(int k=0;k<threads-1;k++){
+        if(pthread_create(&p->th[k],NULL,worker,p)) break;
+        p->n++;
+    }
+    if(p->n==0){ pool_destroy(p); return NULL; }
+    return p;
+}
+
+void pool_for(Pool *p, int ntasks, PoolFn fn, void *ctx){
+    int serial = !p || ntasks<=1;
+    if(!serial){
+        pthread_mutex_lock(&p->mu);
+        if(p->busy) serial=1;
+        else {
+            p->busy=1; p->fn=fn; p->ctx=ctx; p->ntasks=ntasks; p->next=0;
+            p->active=p->n; p->gen++;
+            pthread_cond_broadcast(&p->go);
+        }
+        pthread_mutex_unlock(&p->mu);
+    }
+    if(serial){ for(int k=0;k<ntasks;k++) fn(ctx,k); return; }
+    run_tasks(p);
+    pthread_mutex_lock(&p->mu);
+    while(p->active) pthread_cond_wait(&p->done,&p->mu);
+    p->busy=0;
+    pthread_mutex_unlock(&p->mu);
+}
+
+int pool_threads(const Pool *p){ return p ? p->n+1 : 1; }
+
+void pool_destroy(Pool *p){
+    if(!p) return;
+    pthread_mutex_lock(&p->mu);
+    p->quit=1;
+    pthread_cond_broadcast(&p->go);
+    pthread_mutex_unlock(&p->mu);
+    for(int k=0;k<p->n;k++) pthread_join(p->th[k],NULL);
+    pthread_mutex_destroy(&p->mu);
+    pthread_cond_destroy(&p->go);
+    pthread_cond_destroy(&p->done);
+    free(p->th); free(p);
+}
@@ -0,0 +1,14 @@
+#ifndef POOL_H
+#define POOL_H
+
+/* fixed set of worker threads sharing out the tasks of one parallel loop */
+typedef struct Pool Pool;
+typedef void (*PoolFn)(void *ctx, int task);
+
+Pool *pool_create(int threads);   // threads<=0: one per online CPU; NULL if that is 1
+/* run fn(ctx,0..ntasks-1) and return once all finished; the caller works too.
+   with no pool, or while another thread is using it, the loop runs serially */
+void  pool_for(Pool *p, int ntasks, PoolFn fn, void *ctx);
+int   pool_threads(const Pool *p);
+void  pool_destroy(Pool *p);
+#endif
@@ -0,0 +1,130 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+#include "raymarch.h"
+#include <math.h>
+#include <string.h>
+
+static const char *const RAY_VARS[] = { "p.x", "p.y", "p.z", "t" };
+
+int ray_compile(RxProg *sdf, const char *src, char *err, size_t errsz){
+    return rx_compile(sdf,src,RAY_VARS,4,err,errsz);
+}
+
+int ray_cam_eq(const RayCam *a, const RayCam *b){
+    for(int c=0;c<3;c++)
+        if(a->pos[c]!=b->pos[c] || a->target[c]!=b->target[c] || a->light[c]!=b->light[c]) return 0;
+    return a->fov==b->fov && a->spin==b->spin && a->steps==b->steps && a->eps==b->eps && a->max_dist==b->max_dist;
+}
+
+static void v_norm(double *v){
+    double l=sqrt(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+    if(l>0){ v[0]/=l; v[1]/=l; v[2]/=l; }
+}
+static void v_cross(const double *a, const double *b, double *o){
+    o[0]=a[1]*b[2] - a[2]*b[1];
+    o[1]=a[2]*b[0] - a[0]*b[2];
+    o[2]=a[0]*b[1] - a[1]*b[0];
+}
+
+typedef struct {
+    const RayCam *cam; const RxProg *sdf; double t;
+    int w, h; float *shade;
+    double eye[3], fwd[3], right[3], up[3], light[3];
+    double sx, sy;     // screen half-extent at unit distance
+} RayJob;
+
+/* surface points waiting for their normal; the normal is the tetrahedron
+   gradient, four sdf batches for up to RX_BATCH points */
+typedef struct { double x[RX_BATCH], y[RX_BATCH], z[RX_BATCH]; int cell[RX_BATCH]; int n; } Hits;
+
+static void shade_hits(const RayJob *J, Hits *H){
+    static const double K[4][3] = { { 1,-1,-1 }, { -1,-1,1 }, { -1,1,-1 }, { 1,1,1 } };
+    const double e = J->cam->eps>1e-6 ? J->cam->eps : 1e-6;
+    double px[RX_BATCH], py[RX_BATCH], pz[RX_BATCH], pt[RX_BATCH], d[RX_BATCH];
+    double nx[RX_BATCH]={0}, ny[RX_BATCH]={0}, nz[RX_BATCH]={0};
+    const double *in[4]={ px, py, pz, pt };
+    const int n=H->n;
+    for(int k=0;k<n;k++) pt[k]=J->t;
+    for(int s=0;s<4;s++){
+        for(int k=0;k<n;k++){ px[k]=H->x[k]+e*K[s][0]; py[k]=H->y[k]+e*K[s][1]; pz[k]=H->z[k]+e*K[s][2]; }
+        rx_eval(J->sdf,n,in,d);
+        for(int k=0;k<n;k++){ nx[k]+=K[s][0]*d[k]; ny[k]+=K[s][1]*d[k]; nz[k]+=K[s][2]*d[k]; }
+    }
+    for(int k=0;k<n;k++){
+        double l=sqrt(nx[k]*nx[k] + ny[k]*ny[k] + nz[k]*nz[k]);
+        double dif = l>0 ? (nx[k]*J->light[0] + ny[k]*J->light[1] + nz[k]*J->light[2])/l : 0;
+        if(dif<0) dif=0;
+        J->shade[H->cell[k]] = (float)(0.1 + 0.9*dif);
+    }
+    H->n=0;
+}
+
+static void ray_row(void *ctx, int j){
+    const RayJob *J=(const RayJob*)ctx;
+    const RayCam *cam=J->cam;
+    double ox[RAY_PACKET], oy[RAY_PACKET], oz[RAY_PACKET], dx[RAY_PACKET], dy[RAY_PACKET], dz[RAY_PACKET];
+    double px[RAY_PACKET], py[RAY_PACKET], pz[RAY_PACKET], pt[RAY_PACKET], dist[RAY_PACKET], tt[RAY_PACKET];
+    int cell[RAY_PACKET], steps[RAY_PACKET];
+    const double *in[4]={ px, py, pz, pt };
+    Hits H; H.n=0;
+    const double v = (1 - 2*(j+0.5)/J->h)*J->sy;
+    int next=0, n=0;
+    for(;;){
+        // top the packet up with the row's next rays
+        while(n<RAY_PACKET && next<J->w){
+            const double u = (2*(next+0.5)/J->w - 1)*J->sx;
+            double d[3];
+            for(int c=0;c<3;c++) d[c]=J->fwd[c] + u*J->right[c] + v*J->up[c];
+            v_norm(d);
+            ox[n]=J->eye[0]; oy[n]=J->eye[1]; oz[n]=J->eye[2];
+            dx[n]=d[0]; dy[n]=d[1]; dz[n]=d[2];
+            tt[n]=0; steps[n]=0; pt[n]=J->t;
+            cell[n]=j*J->w + next++;
+            n++;
+        }
+        if(!n) break;
+        for(int k=0;k<n;k++){ px[k]=ox[k]+dx[k]*tt[k]; py[k]=oy[k]+dy[k]*tt[k]; pz[k]=oz[k]+dz[k]*tt[k]; }
+        rx_eval(J->sdf,n,in,dist);
+        int live=0;
+        for(int k=0;k<n;k++){
+            if(dist[k]<cam->eps){
+                H.x[H.n]=px[k]; H.y[H.n]=py[k]; H.z[H.n]=pz[k]; H.cell[H.n]=cell[k];
+                if(++H.n==RX_BATCH) shade_hits(J,&H);
+                continue;
+            }
+            tt[k]+=dist[k];
+            if(tt[k]>cam->max_dist || ++steps[k]>=cam->steps || !(dist[k]==dist[k])){
+                J->shade[cell[k]] = -1;
+                continue;
+            }
+            ox[live]=ox[k]; oy[live]=oy[k]; oz[live]=oz[k];
+            dx[live]=dx[k]; dy[live]=dy[k]; dz[live]=dz[k];
+            tt[live]=tt[k]; steps[live]=steps[k]; cell[live]=cell[k];
+            live++;
+        }
+        n=live;
+    }
+    if(H.n) shade_hits(J,&H);
+}
+
+void ray_render(const RayCam *cam, const RxProg *sdf, double t, int w, int h, float *shade, Pool *pool){
+    RayJob J;
+    memset(&J,0,sizeof(J));
+    J.cam=cam; J.sdf=sdf; J.t=t; J.w=w; J.h=h; J.shade=shade;
+    // the eye circles the target's vertical axis at spin rad/s
+    const double a=cam->spin*t, ca=cos(a), sa=sin(a);
+    const double rx=cam->pos[0]-cam->target[0], rz=cam->pos[2]-cam->target[2];
+    J.eye[0]=cam->target[0] + rx*ca - rz*sa;
+    J.eye[1]=cam->pos[1];
+    J.eye[2]=cam->target[2] + rx*sa + rz*ca;
+    for(int c=0;c<3;c++){ J.fwd[c]=cam->target[c]-J.eye[c]; J.light[c]=cam->light[c]; }
+    v_norm(J.fwd); v_norm(J.light);
+    static const double WORLD_UP[3]={ 0,1,0 };
+    v_cross(J.fwd,WORLD_UP,J.right);
+    if(J.right[0]==0 && J.right[1]==0 && J.right[2]==0) J.right[0]=1;   // looking straight up/down
+    v_norm(J.right);
+    v_cross(J.right,J.fwd,J.up);
+    J.sy = tan(0.5*cam->fov*3.14159265358979323846/180.0);
+    J.sx = J.sy*(double)w/(2.0*(h>0?h:1));
+    pool_for(pool,h,ray_row,&J);
+}
@@ -0,0 +1,26 @@
+#ifndef RAYMARCH_H
+#define RAYMARCH_H
+#include "pool.h"
+#include "rexpr.h"
+
+/* sphere tracing of a signed distance function given as an expression in
+   p.x, p.y, p.z and t. rays march in packets of RAY_PACKET, and a packet is
+   topped up from the row as rays finish, so every sdf evaluation runs full */
+#define RAY_PACKET 8
+
+typedef struct {
+    double pos[3], target[3];   // camera
+    double fov;                 // vertical field of view, degrees
+    double spin;                // orbit the camera about the target's vertical, rad/s
+    double light[3];            // direction towards the light
+    int    steps;               // march budget per ray
+    double eps;                 // a ray is on the surface once the distance drops below this
+    double max_dist;            // and has missed past this
+} RayCam;
+
+int  ray_compile(RxProg *sdf, const char *src, char *err, size_t errsz);
+int  ray_cam_eq(const RayCam *a, const RayCam *b);
+/* shade[w*h]: diffuse light 0..1 where the ray hit, -1 where it missed.
+   cells are taken as twice as tall as wide. rows are spread over pool */
+void ray_render(const RayCam *cam, const RxProg *sdf, double t, int w, int h, float *shade, Pool *pool);
+#endif
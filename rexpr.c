@@ -0,0 +1,367 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+#include "rexpr.h"
+#include "noise.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    OP_K, OP_VAR,
+    OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_MOD, OP_MODF, OP_POW, OP_MIN, OP_MAX, OP_LEN2, OP_NOISE2,
+    OP_NEG, OP_POWI,
+    OP_SIN, OP_COS, OP_TAN, OP_ASIN, OP_ACOS, OP_ATAN, OP_EXP, OP_LOG, OP_SQRT,
+    OP_ABS, OP_FLOOR, OP_CEIL,
+    OP_LEN3, OP_SMIN, OP_NOISE3,
+    OP_FBM
+};
+
+/* the guards match eval_expr() in main.c, down to its two mods: infix
+   "a mod b" guards a zero b like division, mod(a,b) takes b==0 as 1.
+   x^n for whole |n|<=16 multiplies instead of calling pow(), so may differ
+   from it in the last bit */
+static double r_div(double a, double b){ return a/(fabs(b)<1e-300?1e-300:b); }
+static double r_smin(double a, double b, double k){
+    if(k<=0) return a<b ? a : b;
+    double h = 0.5 + 0.5*(b-a)/k;
+    h = h<0 ? 0 : h>1 ? 1 : h;
+    return b + (a-b)*h - k*h*(1-h);
+}
+static double r_powi(double a, int n){
+    double x=1, b=a;
+    int m = n<0 ? -n : n;
+    while(m){ if(m&1) x*=b; b*=b; m>>=1; }
+    return n<0 ? r_div(1,x) : x;
+}
+static double r_fn(int op, double a, double b, double c, double d){
+    switch(op){
+    case OP_ADD:  return a+b;
+    case OP_SUB:  return a-b;
+    case OP_MUL:  return a*b;
+    case OP_DIV:  return r_div(a,b);
+    case OP_MOD:  return fmod(a,(fabs(b)<1e-300?1e-300:b));
+    case OP_MODF: return fmod(a,b==0?1:b);
+    case OP_POW:  return pow(a,b);
+    case OP_MIN:  return a<b ? a : b;
+    case OP_MAX:  return a>b ? a : b;
+    case OP_LEN2: return sqrt(a*a + b*b);
+    case OP_LEN3: return sqrt(a*a + b*b + c*c);
+    case OP_SMIN: return r_smin(a,b,c);
+    case OP_NOISE2: return noise2(a,b);
+    case OP_NOISE3: return noise3(a,b,c);
+    case OP_FBM:  return noise_fbm(a,b,c,d);
+    case OP_NEG:  return -a;
+    case OP_SIN:  return sin(a);
+    case OP_COS:  return cos(a);
+    case OP_TAN:  return tan(a);
+    case OP_ASIN: return asin(a);
+    case OP_ACOS: return acos(a);
+    case OP_ATAN: return atan(a);
+    case OP_EXP:  return exp(a);
+    case OP_LOG:  return log(fabs(a)<1e-300?1e-300:a);
+    case OP_SQRT: return sqrt(fabs(a));
+    case OP_ABS:  return fabs(a);
+    case OP_FLOOR:return floor(a);
+    case OP_CEIL: return ceil(a);
+    default:      return a;
+    }
+}
+static int op_args(int op){
+    if(op>=OP_FBM) return 4;
+    if(op>=OP_LEN3) return 3;
+    if(op>=OP_NEG) return 1;
+    if(op>=OP_ADD) return 2;
+    return 0;
+}
+
+// ---- compiler: recursive descent straight to postfix code -----------------
+typedef struct {
+    const char *s;
+    RxProg *p;
+    const char *const *vars; int nvars;
+    int depth;
+    char *err; size_t errsz;
+    int failed;
+} Rc;
+
+typedef struct { int start; int konst; } Frag;   // konst: code is a single OP_K
+
+static void rc_fail(Rc *c, const char *msg){
+    if(c->failed) return;
+    if(*c->s) snprintf(c->err,c->errsz,"%s near '%.12s'",msg,c->s);
+    else snprintf(c->err,c->errsz,"%s at end",msg);
+    c->failed=1;
+}
+static void rc_ws(Rc *c){ while(*c->s==' '||*c->s=='\t') c->s++; }
+static int  rc_accept(Rc *c, char ch){ rc_ws(c); if(*c->s==ch){ c->s++; return 1; } return 0; }
+static int  ident_char(char ch){ return (ch>='a'&&ch<='z')||(ch>='A'&&ch<='Z')||(ch>='0'&&ch<='9')||ch=='_'; }
+
+// case-insensitive keyword, as match() in main.c
+static int rc_word(Rc *c, const char *w){
+    rc_ws(c);
+    const char *a=c->s;
+    for(;*w;a++,w++){
+        char ca=*a, cw=*w;
+        if(ca>='A'&&ca<='Z') ca+=32;
+        if(cw>='A'&&cw<='Z') cw+=32;
+        if(ca!=cw) return 0;
+    }
+    if(ident_char(*a)) return 0;
+    c->s=a; return 1;
+}
+
+static void rc_emit(Rc *c, int op, int arg, int push){
+    if(c->p->nops>=RX_MAX_OPS){ rc_fail(c,"expression too long"); return; }
+    c->p->op[c->p->nops]=(unsigned char)op;
+    c->p->arg[c->p->nops]=(short)arg;
+    c->p->nops++;
+    c->depth += push;
+    if(c->depth>RX_STACK) rc_fail(c,"expression nests too deep");
+}
+static Frag rc_const(Rc *c, double v){
+    Frag f={ c->p->nops, 1 };
+    if(c->p->nconst>=RX_MAX_CONST){ rc_fail(c,"too many constants"); return f; }
+    c->p->k[c->p->nconst]=v;
+    rc_emit(c,OP_K,c->p->nconst++,+1);
+    return f;
+}
+// drop code from f on; constants are numbered in code order, so the ones it
+// used are the tail of the table
+static void rc_rewind(Rc *c, Frag f, int pops){
+    for(int q=f.start;q<c->p->nops;q++)
+        if(c->p->op[q]==OP_K && c->p->arg[q]<c->p->nconst) c->p->nconst=c->p->arg[q];
+    c->p->nops=f.start;
+    c->depth-=pops;
+}
+
+/* apply op to the n fragments on top of the stack (f[0] deepest); when all
+   of them are constants the result is folded */
+static Frag rc_apply(Rc *c, const Frag *f, int n, int op){
+    int konst=1;
+    for(int k=0;k<n;k++) konst &= f[k].konst;
+    if(konst && !c->failed){
+        double a[4]={0,0,0,0};
+        for(int k=0;k<n;k++) a[k]=c->p->k[c->p->arg[f[k].start]];
+        rc_rewind(c,f[0],n);
+        return rc_const(c,r_fn(op,a[0],a[1],a[2],a[3]));
+    }
+    rc_emit(c,op,0,1-n);
+    Frag r={ f[0].start, 0 };
+    return r;
+}
+
+static Frag rc_expr(Rc *c);
+
+static const struct { const char *name; int op[4]; } RC_FUNCS[] = {   // op by argument count 1..4
+    { "sin",  { OP_SIN } },   { "cos",   { OP_COS } },   { "tan",  { OP_TAN } },
+    { "asin", { OP_ASIN } },  { "acos",  { OP_ACOS } },  { "atan", { OP_ATAN } },
+    { "exp",  { OP_EXP } },   { "log",   { OP_LOG } },   { "sqrt", { OP_SQRT } },
+    { "abs",  { OP_ABS } },   { "floor", { OP_FLOOR } }, { "ceil", { OP_CEIL } },
+    { "min",  { 0, OP_MIN } },{ "max",   { 0, OP_MAX } },{ "pow",  { 0, OP_POW } },
+    { "mod",  { 0, OP_MODF } },
+    { "length",    { OP_ABS, OP_LEN2, OP_LEN3 } },
+    { "smoothmin", { 0, OP_MIN, OP_SMIN } },
+    { "smin",      { 0, OP_MIN, OP_SMIN } },
+    { "noise2",    { 0, OP_NOISE2 } },
+    { "noise3",    { 0, 0, OP_NOISE3 } },
+    { "fbm",       { 0, 0, 0, OP_FBM } },
+};
+
+static Frag rc_primary(Rc *c){
+    rc_ws(c);
+    if(rc_accept(c,'(')){
+        Frag e=rc_expr(c);
+        if(!rc_accept(c,')')) rc_fail(c,"missing ')'");
+        return e;
+    }
+    for(size_t q=0;q<sizeof(RC_FUNCS)/sizeof(RC_FUNCS[0]);q++){
+        const char *save=c->s;
+        if(!rc_word(c,RC_FUNCS[q].name)) continue;
+        if(!rc_accept(c,'(')){ c->s=save; continue; }
+        Frag a[4]; int n=0;
+        do {
+            if(n==4){ rc_fail(c,"too many arguments"); break; }
+            a[n++]=rc_expr(c);
+        } while(rc_accept(c,','));
+        if(!rc_accept(c,')')) rc_fail(c,"missing ')'");
+        int op=RC_FUNCS[q].op[n-1];
+        if(!op){ rc_fail(c,"wrong number of arguments"); return a[0]; }
+        return rc_apply(c,a,n,op);
+    }
+    for(int v=0;v<c->nvars;v++){
+        if(!rc_word(c,c->vars[v])) continue;
+        Frag f={ c->p->nops, 0 };
+        rc_emit(c,OP_VAR,v,+1);
+        c->p->uses |= 1u<<v;
+        return f;
+    }
+    if(rc_word(c,"pi")) return rc_const(c,3.14159265358979323846);
+    char *end; double val=strtod(c->s,&end);
+    if(end==c->s){ rc_fail(c,"unexpected input"); return rc_const(c,0); }
+    c->s=end;
+    return rc_const(c,val);
+}
+static Frag rc_unary(Rc *c){
+    if(rc_accept(c,'+')) return rc_unary(c);
+    if(rc_accept(c,'-')){ Frag a=rc_unary(c); return rc_apply(c,&a,1,OP_NEG); }
+    return rc_primary(c);
+}
+static Frag rc_power(Rc *c){
+    Frag a=rc_unary(c);
+    while(rc_accept(c,'^')){
+        Frag f[2]={ a, rc_unary(c) };
+        double b = f[1].konst ? c->p->k[c->p->arg[f[1].start]] : 0;
+        // small integer exponents become repeated multiplication
+        if(f[1].konst && !a.konst && b==floor(b) && fabs(b)<=16){
+            rc_rewind(c,f[1],1);
+            rc_emit(c,OP_POWI,(int)b,0);
+        }else a=rc_apply(c,f,2,OP_POW);
+    }
+    return a;
+}
+static Frag rc_term(Rc *c){
+    Frag a=rc_power(c);
+    for(;;){
+        int op;
+        if(rc_accept(c,'*')) op=OP_MUL;
+        else if(rc_accept(c,'/')) op=OP_DIV;
+        else if(rc_word(c,"mod")) op=OP_MOD;
+        else return a;
+        Frag f[2]={ a, rc_power(c) };
+        a=rc_apply(c,f,2,op);
+    }
+}
+static Frag rc_expr(Rc *c){
+    Frag a=rc_term(c);
+    for(;;){
+        int op;
+        if(rc_accept(c,'+')) op=OP_ADD;
+        else if(rc_accept(c,'-')) op=OP_SUB;
+        else return a;
+        Frag f[2]={ a, rc_term(c) };
+        a=rc_apply(c,f,2,op);
+    }
+}
+
+int rx_compile(RxProg *p, const char *src, const char *const *vars, int nvars, char *err, size_t errsz){
+    memset(p,0,sizeof(*p));
+    if(nvars>RX_MAX_VARS) nvars=RX_MAX_VARS;
+    Rc c={ src, p, vars, nvars, 0, err, errsz, 0 };
+    if(errsz) err[0]=0;
+    rc_expr(&c);
+    rc_ws(&c);
+    if(*c.s && !c.failed) rc_fail(&c,"trailing input");
+    if(!c.failed && p->nops==0) rc_fail(&c,"empty expression");
+    return c.failed ? -1 : 0;
+}
+
+// ---- vm: one op at a time across the whole batch ----------------------------
+void rx_eval(const RxProg *p, int n, const double *const *in, double *out){
+    double st[RX_STACK][RX_BATCH];
+    int sp=-1;
+    for(int q=0;q<p->nops;q++){
+        const int op=p->op[q];
+        switch(op){
+        case OP_K: { double v=p->k[p->arg[q]]; sp++; for(int k=0;k<n;k++) st[sp][k]=v; break; }
+        case OP_VAR: sp++; memcpy(st[sp],in[p->arg[q]],n*sizeof(double)); break;
+        case OP_ADD: sp--; for(int k=0;k<n;k++) st[sp][k]+=st[sp+1][k]; break;
+        case OP_SUB: sp--; for(int k=0;k<n;k++) st[sp][k]-=st[sp+1][k]; break;
+        case OP_MUL: sp--; for(int k=0;k<n;k++) st[sp][k]*=st[sp+1][k]; break;
+        case OP_MIN: sp--; for(int k=0;k<n;k++) if(st[sp+1][k]<st[sp][k]) st[sp][k]=st[sp+1][k]; break;
+        case OP_MAX: sp--; for(int k=0;k<n;k++) if(st[sp+1][k]>st[sp][k]) st[sp][k]=st[sp+1][k]; break;
+        case OP_LEN2: sp--; for(int k=0;k<n;k++) st[sp][k]=sqrt(st[sp][k]*st[sp][k] + st[sp+1][k]*st[sp+1][k]); break;
+        case OP_LEN3: sp-=2;
+            for(int k=0;k<n;k++) st[sp][k]=sqrt(st[sp][k]*st[sp][k] + st[sp+1][k]*st[sp+1][k] + st[sp+2][k]*st[sp+2][k]);
+            break;
+        case OP_SMIN: sp-=2; for(int k=0;k<n;k++) st[sp][k]=r_smin(st[sp][k],st[sp+1][k],st[sp+2][k]); break;
+        case OP_NOISE2: sp--; noise2_batch(n,st[sp],st[sp+1],st[sp]); break;
+        case OP_NOISE3: sp-=2; noise3_batch(n,st[sp],st[sp+1],st[sp+2],st[sp]); break;
+        case OP_FBM: sp-=3; noise_fbm_batch(n,st[sp],st[sp+1],st[sp+2],st[sp+3],st[sp]); break;
+        case OP_NEG: for(int k=0;k<n;k++) st[sp][k]=-st[sp][k]; break;
+        case OP_ABS: for(int k=0;k<n;k++) st[sp][k]=fabs(st[sp][k]); break;
+        case OP_POWI: {
+            const int e=p->arg[q];
+            if(e==2) for(int k=0;k<n;k++) st[sp][k]*=st[sp][k];
+            else for(int k=0;k<n;k++) st[sp][k]=r_powi(st[sp][k],e);
+            break;
+        }
+        default:
+            if(op_args(op)==2){ sp--; for(int k=0;k<n;k++) st[sp][k]=r_fn(op,st[sp][k],st[sp+1][k],0,0); }
+            else for(int k=0;k<n;k++) st[sp][k]=r_fn(op,st[sp][k],0,0,0);
+            break;
+        }
+    }
+    if(sp<0){ for(int k=0;k<n;k++) out[k]=0; return; }
+    memcpy(out,st[sp],n*sizeof(double));
+}
+
+// ---- hoisting: split off subtrees that don't read the varying inputs -------
+typedef struct {
+    const RxProg *p;
+    short start[RX_MAX_OPS];     // first op of the subtree ending at each op
+    short work[RX_MAX_OPS];      // operators in it
+    unsigned reads[RX_MAX_OPS];  // variables it reads
+    short field[RX_MAX_OPS];     // by subtree start: 1+field number
+    short end[RX_MAX_OPS];       // by subtree start: last op of the field
+    unsigned vary;
+    int nf, maxf;
+} Hoist;
+
+static int ho_args(int op){ return op==OP_POWI ? 1 : op_args(op); }
+
+static void ho_pick(Hoist *h, int q){
+    if(!(h->reads[q] & h->vary) && h->reads[q] && h->work[q] && h->nf<h->maxf){
+        h->field[h->start[q]] = (short)(1 + h->nf++);
+        h->end[h->start[q]] = (short)q;
+        return;
+    }
+    for(int a=ho_args(h->p->op[q]),c=q-1;a>0;a--,c=h->start[c]-1) ho_pick(h,c);
+}
+
+// copy ops [s,e] into d, constants and all
+static void ho_copy(RxProg *d, const RxProg *p, int s, int e){
+    for(int q=s;q<=e;q++){
+        d->op[d->nops]=p->op[q];
+        d->arg[d->nops]=p->arg[q];
+        if(p->op[q]==OP_K){ d->k[d->nconst]=p->k[p->arg[q]]; d->arg[d->nops]=(short)d->nconst++; }
+        if(p->op[q]==OP_VAR) d->uses |= 1u<<p->arg[q];
+        d->nops++;
+    }
+}
+
+int rx_hoist(RxProg *p, unsigned vary, int nvars, RxProg *fields, int maxfields){
+    static Hoist h;   // too big for a worker's stack; only called from the main thread
+    int st[RX_STACK+1], sp=0;
+    if(maxfields>RX_MAX_VARS-nvars) maxfields=RX_MAX_VARS-nvars;
+    if(maxfields<=0 || p->nops==0) return 0;
+    memset(&h,0,sizeof(h));
+    h.p=p; h.vary=vary; h.maxf=maxfields;
+    for(int q=0;q<p->nops;q++){
+        const int op=p->op[q];
+        h.start[q]=(short)q;
+        if(op==OP_VAR) h.reads[q]=1u<<p->arg[q];
+        for(int a=ho_args(op);a>0 && sp>0;a--){
+            const int c=st[--sp];
+            h.start[q]=h.start[c]; h.reads[q]|=h.reads[c]; h.work[q]+=h.work[c];
+        }
+        if(op!=OP_K && op!=OP_VAR) h.work[q]++;
+        st[sp++]=q;
+    }
+    ho_pick(&h,p->nops-1);
+    if(!h.nf) return 0;
+    RxProg out;
+    memset(&out,0,sizeof(out));
+    for(int q=0;q<p->nops;){
+        const int f=h.field[q]-1;
+        if(f<0){ ho_copy(&out,p,q,q); q++; continue; }
+        const int e=h.end[q];
+        memset(&fields[f],0,sizeof(fields[f]));
+        ho_copy(&fields[f],p,q,e);
+        out.op[out.nops]=OP_VAR; out.arg[out.nops]=(short)(nvars+f); out.nops++;
+        out.uses |= 1u<<(nvars+f);
+        q=e+1;
+    }
+    *p=out;
+    return h.nf;
+}
@@ -0,0 +1,33 @@
+#ifndef REXPR_H
+#define REXPR_H
+#include <stddef.h>
+
+/* real-valued expressions in the [expr] grammar, compiled once to a stack
+   bytecode and run over a batch of lanes per call. the caller names the
+   variables (e.g. "p.x"); beyond the [expr] functions there are
+   length(x[,y[,z]]), smoothmin(a,b,k) (alias smin), gradient noise
+   noise2(x,y), noise3(x,y,z) and fbm(x,y,z,octaves) */
+#define RX_MAX_OPS   512
+#define RX_MAX_CONST 128
+#define RX_MAX_VARS  16
+#define RX_STACK     24
+#define RX_BATCH     64
+
+typedef struct {
+    unsigned char op[RX_MAX_OPS];
+    short         arg[RX_MAX_OPS];    // constant / variable index, integer power
+    double        k[RX_MAX_CONST];
+    int           nops, nconst;
+    unsigned      uses;               // bit v set if variable v is read
+} RxProg;
+
+/* vars[0..nvars-1] are the names; 0 on success, -1 with a message in err */
+int  rx_compile(RxProg *p, const char *src, const char *const *vars, int nvars, char *err, size_t errsz);
+/* out[k] = f(in[0][k], in[1][k], ...) for k < n (n <= RX_BATCH) */
+void rx_eval(const RxProg *p, int n, const double *const *in, double *out);
+/* move the largest subtrees that do some work but read none of the vary
+   variables into fields[0..], at most maxfields of them; p then reads
+   field f as variable nvars+f. fields read p's own variables. returns the
+   number of fields */
+int  rx_hoist(RxProg *p, unsigned vary, int nvars, RxProg *fields, int maxfields);
+#endif
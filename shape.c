@@ -0,0 +1,121 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+#include "shape.h"
+#include <string.h>
+
+#define SHAPE_TAU  0.125   // |offset from the mean| counted as a deviation
+#define SHAPE_STEP 0.3     // offset a deviation stands for when the table is built
+
+/* coverage of each 2x3 sixth of the cell, hex 0..f; the cell is the
+   font's advance wide and ascent+descent tall */
+static const char SHAPE_ASCII[95][SHAPE_N+1] = {   // U+0020..007E
+    "000000", "112211", "221100", "228821", "234534", "305503", "316433", "110000",
+    "024012", "200421", "222200", "004400", "000032", "002200", "000011", "022230",
+    "336622", "221423", "232432", "231533", "135602", "423533", "326523", "341420",
+    "336633", "334622", "001111", "001132", "005501", "005500", "005510", "231311",
+    "227645", "226622", "437633", "325023", "425532", "436232", "436320", "325423",
+    "226622", "333322", "130532", "237422", "205032", "447722", "427723", "335533",
+    "436420", "335534", "436622", "323433", "443311", "225533", "225511", "228822",
+    "334522", "334411", "352332", "224132", "203203", "221423", "221100", "000022",
+    "200000", "005633", "306533", "005222", "035633", "007522", "134411", "005646",
+    "306522", "113323", "012423", "306522", "414112", "007722", "006522", "005533",
+    "006563", "005535", "005320", "004422", "206212", "005533", "005511", "006622",
+    "005522", "005542", "003432", "134213", "112222", "312431", "003300",
+};
+static const char SHAPE_BLOCK[32][SHAPE_N+1] = {   // U+2580..259F
+    "ff8800", "000066", "0000bb", "0022ff", "0088ff", "00ddff", "44ffff", "99ffff",
+    "ffffff", "fbfbfb", "f8f8f8", "f4f4f4", "f0f0f0", "b0b0b0", "808080", "404040",
+    "0f0f0f", "332233", "878878", "ccddcc", "660000", "040404", "0080f0", "00080f",
+    "f08000", "f0f8ff", "f0880f", "fff8f0", "ff8f0f", "0f0800", "0f88f0", "0f8fff",
+};
+
+static int hexval(char c){
+    if(c>='0' && c<='9') return c-'0';
+    if(c>='a' && c<='f') return c-'a'+10;
+    if(c>='A' && c<='F') return c-'A'+10;
+    return -1;
+}
+
+static int desc_from_hex(const char *s, ShapeDesc *d){
+    for(int k=0;k<SHAPE_N;k++){
+        int v=hexval(s[k]);
+        if(v<0) return 0;
+        d->d[k]=(unsigned char)v;
+    }
+    return 1;
+}
+
+int shape_builtin(const char *utf8, ShapeDesc *d){
+    const unsigned char *u=(const unsigned char*)utf8;
+    unsigned cp;
+    if(u[0]<0x80 && u[0] && !u[1]) cp=u[0];
+    else if((u[0]>>4)==0xE && (u[1]>>6)==2 && (u[2]>>6)==2 && !u[3]) cp=(u[0]&0x0Fu)<<12 | (u[1]&0x3Fu)<<6 | (u[2]&0x3Fu);
+    else return 0;
+    if(cp>=0x20 && cp<0x7F) return desc_from_hex(SHAPE_ASCII[cp-0x20],d);
+    if(cp>=0x2580 && cp<0x25A0) return desc_from_hex(SHAPE_BLOCK[cp-0x2580],d);
+    return 0;
+}
+
+int shape_parse(const char *s, ShapeDesc *d, unsigned char *known, int max){
+    int n=0;
+    while(n<max){
+        while(*s==' ' || *s=='\t' || *s==',') s++;
+        if(!*s) break;
+        const char *e=s;
+        while(*e && *e!=' ' && *e!='\t' && *e!=',') e++;
+        known[n] = (e-s==SHAPE_N) && desc_from_hex(s,&d[n]);
+        n++;
+        s=e;
+    }
+    return n;
+}
+
+void shape_build(ShapeMap *m, const ShapeDesc *d, const unsigned char *known, int n){
+    float c[256][SHAPE_N];
+    int top=0;
+    if(n>256) n=256;
+    for(int g=0;g<n;g++)
+        if(known[g]) for(int k=0;k<SHAPE_N;k++) if(d[g].d[k]>top) top=d[g].d[k];
+    for(int g=0;g<n;g++)
+        for(int k=0;k<SHAPE_N;k++)
+            c[g][k] = known[g] ? (top ? (float)d[g].d[k]/top : 0.f) : (n>1 ? (float)g/(n-1) : 0.f);
+    for(int key=0;key<SHAPE_KEYS;key++){
+        // the sample pattern a key stands for, offsets balanced about its mean
+        const double mean=(key/729 + 0.5)/SHAPE_MEANS;
+        double tg[SHAPE_N], off=0;
+        for(int k=0,p=key%729;k<SHAPE_N;k++,p/=3){ tg[k]=(p%3-1)*SHAPE_STEP; off+=tg[k]; }
+        for(int k=0;k<SHAPE_N;k++){
+            double v=mean + tg[k] - off/SHAPE_N;
+            tg[k] = v<0 ? 0 : v>1 ? 1 : v;
+        }
+        // squared error per sample plus the error of the cell's overall tone
+        double best=1e30; int bi=0;
+        for(int g=0;g<n;g++){
+            double e2=0, e1=0;
+            for(int k=0;k<SHAPE_N;k++){ double e=c[g][k]-tg[k]; e2+=e*e; e1+=e; }
+            e2+=e1*e1/SHAPE_N;
+            if(e2<best){ best=e2; bi=g; }
+        }
+        m->lut[key]=(unsigned char)bi;
+    }
+    m->valid=1;
+}
+
+int shape_key(const float *v, int stride){
+    float s[SHAPE_N], mean=0;
+    for(int y=0;y<SHAPE_ROWS;y++)
+        for(int x=0;x<SHAPE_COLS;x++){
+            float t=(v[y*stride+x]+1.f)*0.5f;
+            t = t<0 ? 0 : t>1 ? 1 : t==t ? t : 0.5f;
+            s[y*SHAPE_COLS+x]=t; mean+=t;
+        }
+    mean/=SHAPE_N;
+    int mq=(int)(mean*SHAPE_MEANS);
+    if(mq>=SHAPE_MEANS) mq=SHAPE_MEANS-1;
+    int key=0;
+    for(int k=SHAPE_N-1;k>=0;k--){
+        const float o=s[k]-mean;
+        key = key*3 + (o<-SHAPE_TAU ? 0 : o>SHAPE_TAU ? 2 : 1);
+    }
+    return mq*729 + key;
+}
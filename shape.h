@@ -0,0 +1,33 @@
+#ifndef SHAPE_H
+#define SHAPE_H
+
+/* glyph choice by shape. every glyph has a descriptor of SHAPE_COLS x
+   SHAPE_ROWS sub-cell ink coverages (0..15, rows from the top left) and a
+   cell takes the glyph nearest its own samples. the search runs once per
+   charset into a table keyed by the quantized sample mean and the sign of
+   each sample's offset from that mean, so a cell costs one lookup */
+#define SHAPE_COLS 2
+#define SHAPE_ROWS 3
+#define SHAPE_N (SHAPE_COLS*SHAPE_ROWS)
+#define SHAPE_MEANS 16                  // mean levels in a key
+#define SHAPE_KEYS  (SHAPE_MEANS*729)   // times 3^SHAPE_N offset patterns
+
+typedef struct { unsigned char d[SHAPE_N]; } ShapeDesc;
+
+typedef struct {
+    unsigned char lut[SHAPE_KEYS];      // charset index per key
+    int           valid;
+} ShapeMap;
+
+/* descriptors measured from DejaVu Sans Mono for printable ascii and the
+   block elements U+2580..259F; 0 for anything else */
+int  shape_builtin(const char *utf8, ShapeDesc *d);
+/* "0011ff 00ff00 -" one 6-digit hex group per glyph, '-' where there is
+   none: sets d[k] and known[k], returns the number of groups read */
+int  shape_parse(const char *s, ShapeDesc *d, unsigned char *known, int max);
+/* coverages are scaled by the charset's densest sample; a glyph without a
+   descriptor counts as flat at its place in the ramp */
+void shape_build(ShapeMap *m, const ShapeDesc *d, const unsigned char *known, int n);
+/* key of SHAPE_ROWS rows of SHAPE_COLS samples in -1..1, rows stride apart */
+int  shape_key(const float *v, int stride);
+#endif
@@ -0,0 +1,284 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+#include "sim.h"
+#include "vec.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIM_BAND 8   // rows per task: a band and its two halo rows stay in cache
+
+int sim_parse_rule(const char *s, unsigned *birth, unsigned *survive){
+    unsigned b=0, sv=0, *cur=NULL;
+    int slash=0, any=0;
+    for(;*s;s++){
+        char c=*s;
+        if(c=='B' || c=='b') cur=&b;
+        else if(c=='S' || c=='s') cur=&sv;
+        else if(c=='/'){ slash++; cur=NULL; }
+        else if(c>='0' && c<='8'){
+            // bare "23/3" is survive/birth
+            unsigned *dst = cur ? cur : (slash ? &b : &sv);
+            *dst |= 1u<<(c-'0'); any=1;
+        }
+        else if(c!=' ') return 0;
+    }
+    if(!any || slash>1) return 0;
+    *birth=b; *survive=sv;
+    return 1;
+}
+
+void sim_rule_str(unsigned birth, unsigned survive, char *out, size_t n){
+    char buf[24]; int k=0;
+    buf[k++]='B';
+    for(int i=0;i<=8;i++) if(birth>>i & 1) buf[k++]=(char)('0'+i);
+    buf[k++]='/'; buf[k++]='S';
+    for(int i=0;i<=8;i++) if(survive>>i & 1) buf[k++]=(char)('0'+i);
+    buf[k]=0;
+    snprintf(out,n,"%s",buf);
+}
+
+static uint32_t rng_next(uint32_t *s){   // xorshift32
+    uint32_t x=*s; x^=x<<13; x^=x>>17; x^=x<<5; return *s=x;
+}
+
+// ---- life: 64 cells per word, neighbour counts added bit-sliced -----------------
+static void life_seed(Sim *s){
+    uint32_t r = s->p.seed ? s->p.seed : 1;
+    const uint32_t cut = (uint32_t)(s->p.density*4294967295.0);
+    memset(s->bits[0],0,(size_t)s->words*s->h*sizeof(uint64_t));
+    for(int y=0;y<s->h;y++)
+        for(int x=0;x<s->w;x++)
+            if(rng_next(&r)<cut) s->bits[0][(size_t)y*s->words + x/64] |= 1ull<<(x%64);
+}
+
+/* row shifted so bit x holds cell x-1 (west) or x+1 (east), wrapping at w;
+   bits past w in the last word stay clear */
+static uint64_t west(const uint64_t *row, int k, int words, int w){
+    uint64_t in = k ? row[k-1]>>63 : row[words-1]>>((w-1)%64) & 1;
+    return row[k]<<1 | in;
+}
+static uint64_t east(const uint64_t *row, int k, int words, int w){
+    if(k<words-1) return row[k]>>1 | row[k+1]<<63;
+    return row[k]>>1 | (row[0]&1)<<((w-1)%64);
+}
+
+typedef struct { Sim *s; const uint64_t *src; uint64_t *dst; } LifeJob;
+
+static void life_band(void *ctx, int band){
+    const LifeJob *J=(const LifeJob*)ctx;
+    const Sim *s=J->s;
+    const int W=s->words, w=s->w, h=s->h;
+    const uint64_t last = (w%64) ? (1ull<<(w%64))-1 : ~0ull;
+    const unsigned B=s->p.birth, S=s->p.survive;
+    const int y1 = (band+1)*SIM_BAND<h ? (band+1)*SIM_BAND : h;
+    for(int y=band*SIM_BAND;y<y1;y++){
+        const uint64_t *up=J->src+(size_t)((y+h-1)%h)*W, *mid=J->src+(size_t)y*W, *dn=J->src+(size_t)((y+1)%h)*W;
+        uint64_t *out=J->dst+(size_t)y*W;
+        for(int k=0;k<W;k++){
+            uint64_t n[8] = { west(up,k,W,w), up[k], east(up,k,W,w), west(mid,k,W,w),
+                              east(mid,k,W,w), west(dn,k,W,w), dn[k], east(dn,k,W,w) };
+            // full adders: eight 1-bit counts -> ones/twos/fours/eights planes
+            uint64_t s1=n[0]^n[1]^n[2], c1=(n[0]&n[1])|(n[2]&(n[0]^n[1]));
+            uint64_t s2=n[3]^n[4]^n[5], c2=(n[3]&n[4])|(n[5]&(n[3]^n[4]));
+            uint64_t s3=n[6]^n[7],      c3=n[6]&n[7];
+            uint64_t ones=s1^s2^s3,     c4=(s1&s2)|(s3&(s1^s2));
+            uint64_t t1=c1^c2^c3,       d1=(c1&c2)|(c3&(c1^c2));
+            uint64_t twos=t1^c4,        d2=t1&c4;
+            uint64_t fours=d1^d2,       eights=d1&d2;
+            const uint64_t alive=mid[k];
+            uint64_t next=0;
+            for(int c=0;c<=8;c++){
+                int b=B>>c & 1, sv=S>>c & 1;
+                if(!b && !sv) continue;
+                uint64_t eq = (c&1 ? ones : ~ones) & (c&2 ? twos : ~twos) & (c&4 ? fours : ~fours) & (c&8 ? eights : ~eights);
+                next |= eq & ((sv ? alive : 0) | (b ? ~alive : 0));
+            }
+            out[k] = k==W-1 ? next&last : next;
+        }
+    }
+}
+
+// ---- gray-scott / heat: float fields, 3x3 stencil rows ----------------------------
+static void gs_seed(Sim *s){
+    uint32_t r = s->p.seed ? s->p.seed : 1;
+    const size_t n=(size_t)s->w*s->h;
+    float *u=s->f[0][0], *v=s->f[0][1];
+    for(size_t k=0;k<n;k++){ u[k]=1; v[k]=0; }
+    // a few squares of v to start the reaction
+    int spots = 4 + (int)(n/4000);
+    int side = (s->w<s->h ? s->w : s->h)/10 + 2;
+    for(int q=0;q<spots;q++){
+        int x0=(int)(rng_next(&r)%(uint32_t)s->w), y0=(int)(rng_next(&r)%(uint32_t)s->h);
+        for(int y=0;y<side;y++) for(int x=0;x<side;x++){
+            size_t k=(size_t)((y0+y)%s->h)*s->w + (x0+x)%s->w;
+            u[k]=0.5f; v[k]=0.25f;
+        }
+    }
+}
+
+typedef struct { Sim *s; int src, dst; } FieldJob;
+
+/* 3x3 laplacian: 0.2 edge-adjacent, 0.05 diagonal, -1 center. AT reads one
+   float or one vector of them, so edges and row interiors share the formula */
+#define LAP(AT,a,b,c,x,xm,xp) (0.2f*(AT(a,x)+AT(c,x)+AT(b,xm)+AT(b,xp)) + 0.05f*(AT(a,xm)+AT(a,xp)+AT(c,xm)+AT(c,xp)) - AT(b,x))
+#define AT1(p,i) (p)[i]
+#define GS_CELL(AT,x,xm,xp) do{ \
+        u=AT(ub,x); v=AT(vb,x); uvv=u*v*v; \
+        un = u + Du*LAP(AT,ua,ub,uc,x,xm,xp) - uvv + F*(1-u); \
+        vn = v + Dv*LAP(AT,va,vb,vc,x,xm,xp) + uvv - (F+K)*v; }while(0)
+#define HEAT_CELL(AT,x,xm,xp) (keep*(AT(b,x) + A*(AT(a,x)+AT(c,x)+AT(b,xm)+AT(b,xp)-4*AT(b,x))))
+
+#if defined(__GNUC__)
+#define SIM_LANES (FRAC_VEC_BYTES/4)
+static inline vf32 vld(const float *p){ vf32 v; memcpy(&v,p,sizeof(v)); return v; }
+static inline void vst(float *p, vf32 v){ memcpy(p,&v,sizeof(v)); }
+#define ATV(p,i) vld((p)+(i))
+#endif
+
+/* x0..x1 is the row interior: no wrap, whole vectors, then a scalar tail */
+static void gs_span(const float *ua, const float *ub, const float *uc, const float *va, const float *vb, const float *vc,
+                    float *uo, float *vo, int x, int x1, float F, float K, float Du, float Dv){
+#ifdef SIM_LANES
+    for(;x+SIM_LANES<=x1;x+=SIM_LANES){
+        vf32 u, v, uvv, un, vn;
+        GS_CELL(ATV,x,x-1,x+1);
+        vst(uo+x,un); vst(vo+x,vn);
+    }
+#endif
+    for(;x<x1;x++){
+        float u, v, uvv, un, vn;
+        GS_CELL(AT1,x,x-1,x+1);
+        uo[x]=un; vo[x]=vn;
+    }
+}
+
+static void gs_band(void *ctx, int band){
+    const FieldJob *J=(const FieldJob*)ctx;
+    const Sim *s=J->s;
+    const int w=s->w, h=s->h;
+    const float F=(float)s->p.feed, K=(float)s->p.kill, Du=(float)s->p.du, Dv=(float)s->p.dv;
+    const int y1 = (band+1)*SIM_BAND<h ? (band+1)*SIM_BAND : h;
+    for(int y=band*SIM_BAND;y<y1;y++){
+        const size_t ru=(size_t)((y+h-1)%h)*w, rm=(size_t)y*w, rd=(size_t)((y+1)%h)*w;
+        const float *ua=s->f[J->src][0]+ru, *ub=s->f[J->src][0]+rm, *uc=s->f[J->src][0]+rd;
+        const float *va=s->f[J->src][1]+ru, *vb=s->f[J->src][1]+rm, *vc=s->f[J->src][1]+rd;
+        float *uo=s->f[J->dst][0]+rm, *vo=s->f[J->dst][1]+rm;
+        gs_span(ua,ub,uc,va,vb,vc,uo,vo,1,w-1,F,K,Du,Dv);
+        for(int x=0;x<w;x+=(w>1 ? w-1 : 1)){   // the two wrapping edge cells
+            const int xm=(x+w-1)%w, xp=(x+1)%w;
+            float u, v, uvv, un, vn;
+            GS_CELL(AT1,x,xm,xp);
+            uo[x]=un; vo[x]=vn;
+        }
+    }
+}
+
+static void heat_band(void *ctx, int band){
+    const FieldJob *J=(const FieldJob*)ctx;
+    const Sim *s=J->s;
+    const int w=s->w, h=s->h;
+    const float A=(float)s->p.alpha, keep=(float)(1.0-s->p.cool);
+    const int y1 = (band+1)*SIM_BAND<h ? (band+1)*SIM_BAND : h;
+    for(int y=band*SIM_BAND;y<y1;y++){
+        const float *a=s->f[J->src][0]+(size_t)((y+h-1)%h)*w, *b=s->f[J->src][0]+(size_t)y*w, *c=s->f[J->src][0]+(size_t)((y+1)%h)*w;
+        float *o=s->f[J->dst][0]+(size_t)y*w;
+        int x=1;
+#ifdef SIM_LANES
+        for(;x+SIM_LANES<=w-1;x+=SIM_LANES) vst(o+x,HEAT_CELL(ATV,x,x-1,x+1));
+#endif
+        for(;x<w-1;x++) o[x]=HEAT_CELL(AT1,x,x-1,x+1);
+        for(x=0;x<w;x+=(w>1 ? w-1 : 1)){
+            const int xm=(x+w-1)%w, xp=(x+1)%w;
+            o[x]=HEAT_CELL(AT1,x,xm,xp);
+        }
+    }
+}
+
+// three emitters on lissajous tracks keep heat flowing in
+static void heat_sources(Sim *s){
+    float *T=s->f[s->cur][0];
+    const double th = s->steps*0.004;
+    const int r = (s->w<s->h ? s->w : s->h)/16 + 1;
+    for(int q=0;q<3;q++){
+        double ph = th + q*2.0943951023931953;
+        int cx = (int)((0.5 + 0.35*cos(ph*(1+q*0.3)))*s->w), cy = (int)((0.5 + 0.35*sin(2*ph))*s->h);
+        for(int y=-r;y<=r;y++) for(int x=-r;x<=r;x++){
+            if(x*x+y*y>r*r) continue;
+            T[(size_t)(((cy+y)%s->h+s->h)%s->h)*s->w + ((cx+x)%s->w+s->w)%s->w] = 1;
+        }
+    }
+}
+
+static int params_eq(const SimParams *a, const SimParams *b){
+    return a->kind==b->kind && a->birth==b->birth && a->survive==b->survive && a->density==b->density &&
+           a->feed==b->feed && a->kill==b->kill && a->du==b->du && a->dv==b->dv &&
+           a->alpha==b->alpha && a->cool==b->cool && a->seed==b->seed;
+}
+
+int sim_reset(Sim *s, const SimParams *p, int w, int h){
+    if(s->valid && s->w==w && s->h==h && params_eq(&s->p,p)) return 0;
+    s->valid=0;
+    if(w<=0 || h<=0) return -1;
+    const size_t n=(size_t)w*h;
+    const int words=(w+63)/64;
+    for(int b=0;b<2;b++){
+        if(p->kind==SIM_LIFE){
+            uint64_t *q=(uint64_t*)realloc(s->bits[b],(size_t)words*h*sizeof(uint64_t));
+            if(!q) return -1;
+            s->bits[b]=q;
+        }else for(int f=0;f<2;f++){
+            float *q=(float*)realloc(s->f[b][f],n*sizeof(float));
+            if(!q) return -1;
+            s->f[b][f]=q;
+        }
+    }
+    s->p=*p; s->w=w; s->h=h; s->words=words; s->cur=0; s->steps=0;
+    if(p->kind==SIM_LIFE) life_seed(s);
+    else if(p->kind==SIM_GRAYSCOTT) gs_seed(s);
+    else memset(s->f[0][0],0,n*sizeof(float));
+    s->valid=1;
+    return 1;
+}
+
+void sim_step(Sim *s, int n, Pool *pool){
+    if(!s->valid) return;
+    const int bands=(s->h+SIM_BAND-1)/SIM_BAND;
+    for(int k=0;k<n;k++){
+        if(s->p.kind==SIM_LIFE){
+            LifeJob J={ s, s->bits[s->cur], s->bits[!s->cur] };
+            pool_for(pool,bands,life_band,&J);
+        }else{
+            if(s->p.kind==SIM_HEAT) heat_sources(s);
+            FieldJob J={ s, s->cur, !s->cur };
+            pool_for(pool,bands,s->p.kind==SIM_HEAT ? heat_band : gs_band,&J);
+        }
+        s->cur=!s->cur;
+        s->steps++;
+    }
+}
+
+void sim_sample(const Sim *s, int cw, int ch, int scale, float *out){
+    const float norm = 1.0f/(float)(scale*scale);
+    for(int j=0;j<ch;j++){
+        for(int i=0;i<cw;i++){
+            float acc=0;
+            for(int y=j*scale;y<(j+1)*scale && y<s->h;y++){
+                for(int x=i*scale;x<(i+1)*scale && x<s->w;x++){
+                    if(s->p.kind==SIM_LIFE) acc += (float)(s->bits[s->cur][(size_t)y*s->words + x/64]>>(x%64) & 1);
+                    // gray-scott v tops out near 0.4
+                    else if(s->p.kind==SIM_GRAYSCOTT) acc += 2.5f*s->f[s->cur][1][(size_t)y*s->w+x];
+                    else acc += s->f[s->cur][0][(size_t)y*s->w+x];
+                }
+            }
+            acc *= norm;
+            out[(size_t)j*cw+i] = acc<0 ? 0 : acc>1 ? 1 : acc;
+        }
+    }
+}
+
+void sim_free(Sim *s){
+    for(int b=0;b<2;b++){ free(s->bits[b]); free(s->f[b][0]); free(s->f[b][1]); }
+    memset(s,0,sizeof(*s));
+}
@@ -0,0 +1,46 @@
+#ifndef SIM_H
+#define SIM_H
+#include <stddef.h>
+#include <stdint.h>
+#include "pool.h"
+
+/* grid simulations stepped independently of the frame rate. the grid is
+   the cell grid times scale; each display cell shows the mean of its
+   scale x scale block. all grids wrap around at the edges */
+typedef enum { SIM_LIFE=0, SIM_GRAYSCOTT, SIM_HEAT } SimKind;
+
+#define SIM_HEAT_MAX_ALPHA 0.25   // past this the explicit 5-point heat step oscillates and blows up
+
+typedef struct {
+    SimKind  kind;
+    unsigned birth, survive;   // life: bit n set = born / survives with n neighbours
+    double   density;          // life: initial fill
+    double   feed, kill;       // gray-scott
+    double   du, dv;           // gray-scott diffusion rates
+    double   alpha, cool;      // heat: diffusion per step, fraction lost per step
+    unsigned seed;
+} SimParams;
+
+typedef struct {
+    SimParams p;
+    int       w, h;
+    int       words;           // life: 64-cell words per row
+    uint64_t *bits[2];         // life: bit-packed rows, double buffered
+    float    *f[2][2];         // [buffer][field]: gray-scott u,v; heat uses field 0
+    int       cur;             // buffer holding the current state
+    long      steps;
+    int       valid;
+} Sim;
+
+/* "B3/S23" (also "23/3"); 0 on junk */
+int  sim_parse_rule(const char *s, unsigned *birth, unsigned *survive);
+void sim_rule_str(unsigned birth, unsigned survive, char *out, size_t n);
+/* (re)seed for p at w x h unless that is what is running: 1 if it seeded,
+   0 if not, -1 on allocation failure */
+int  sim_reset(Sim *s, const SimParams *p, int w, int h);
+/* advance n steps; row bands of every step are spread over pool */
+void sim_step(Sim *s, int n, Pool *pool);
+/* mean of each scale x scale block into out[cw*ch], 0..1 */
+void sim_sample(const Sim *s, int cw, int ch, int scale, float *out);
+void sim_free(Sim *s);
+#endif
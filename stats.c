@@ -0,0 +1,74 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+#include "stats.h"
+#include "util.h"
+#include <stdlib.h>
+#include <string.h>
+
+const char *const STAGE_NAMES[STAGE_COUNT] = { "input", "eval", "iterate", "encode", "write", "sleep" };
+Stats g_stats;
+static int g_log_json;
+
+void stats_reset(void){ memset(&g_stats,0,sizeof(g_stats)); }
+
+void stats_frame_begin(void){ g_stats.begin = now_sec(); }
+
+double stats_lap(Stage s, double since){
+    const double now = now_sec();
+    g_stats.stage[s] += now - since;
+    return now;
+}
+
+static int cmp_double(const void *a, const void *b){
+    const double x=*(const double*)a, y=*(const double*)b;
+    return (x>y) - (x<y);
+}
+
+void stats_frame_end(unsigned long long bytes, unsigned long long writes){
+    Stats *s = &g_stats;
+    const double end = now_sec();
+    s->bytes = bytes - s->bytes_at;   s->bytes_at = bytes;
+    s->writes = writes - s->writes_at; s->writes_at = writes;
+    for(int k=0;k<STAGE_COUNT;k++){ s->last[k]=s->stage[k]; s->total[k]+=s->stage[k]; s->stage[k]=0; }
+    s->work[s->ring] = end - s->begin - s->last[STAGE_SLEEP];
+    s->gap[s->ring] = s->frames ? end - s->end : end - s->begin;
+    s->end = end;
+    s->ring = (s->ring+1) % STATS_RING;
+    if(s->nring<STATS_RING) s->nring++;
+    s->frames++;
+
+    // nearest rank over the ring; 256 doubles sort in a few microseconds
+    double sorted[STATS_RING], span=0;
+    for(int k=0;k<s->nring;k++){ sorted[k]=s->work[k]; span+=s->gap[k]; }
+    qsort(sorted,(size_t)s->nring,sizeof(double),cmp_double);
+    s->p50 = sorted[(s->nring-1)/2];
+    s->p99 = sorted[(s->nring*99+99)/100-1];
+    s->fps = span>0 ? s->nring/span : 0;
+}
+
+FILE *stats_log_open(const char *path){
+    FILE *f = fopen(path,"w");
+    if(!f) return NULL;
+    const char *dot = strrchr(path,'.');
+    g_log_json = dot && (!strcmp(dot,".json") || !strcmp(dot,".jsonl"));
+    if(!g_log_json){
+        fprintf(f,"frame,t,fps,p50_ms,p99_ms");
+        for(int k=0;k<STAGE_COUNT;k++) fprintf(f,",%s_ms",STAGE_NAMES[k]);
+        fprintf(f,",bytes,writes\n");
+    }
+    return f;
+}
+
+void stats_log_frame(FILE *f, double t){
+    const Stats *s = &g_stats;
+    if(g_log_json){
+        fprintf(f,"{\"frame\":%ld,\"t\":%.4f,\"fps\":%.2f,\"p50_ms\":%.3f,\"p99_ms\":%.3f",
+            s->frames-1, t, s->fps, s->p50*1e3, s->p99*1e3);
+        for(int k=0;k<STAGE_COUNT;k++) fprintf(f,",\"%s_ms\":%.3f",STAGE_NAMES[k],s->last[k]*1e3);
+        fprintf(f,",\"bytes\":%llu,\"writes\":%llu}\n", s->bytes, s->writes);
+    }else{
+        fprintf(f,"%ld,%.4f,%.2f,%.3f,%.3f", s->frames-1, t, s->fps, s->p50*1e3, s->p99*1e3);
+        for(int k=0;k<STAGE_COUNT;k++) fprintf(f,",%.3f",s->last[k]*1e3);
+        fprintf(f,",%llu,%llu\n", s->bytes, s->writes);
+    }
+}
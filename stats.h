@@ -0,0 +1,48 @@
+#ifndef STATS_H
+#define STATS_H
+#include <stdio.h>
+
+/* where each frame's time goes. stages add to the open frame with
+   stats_lap(); stats_frame_end() closes it, keeps it as the last frame and
+   folds it into the totals. timers are clock_gettime reads, a dozen or so
+   per frame, so this stays on all the time */
+typedef enum { STAGE_INPUT, STAGE_EVAL, STAGE_ITERATE, STAGE_ENCODE, STAGE_WRITE, STAGE_SLEEP, STAGE_COUNT } Stage;
+extern const char *const STAGE_NAMES[STAGE_COUNT];
+
+#define STATS_RING 256   // frames the fps and percentiles look back over
+
+typedef struct {
+    double   stage[STAGE_COUNT];   // open frame, seconds
+    double   last[STAGE_COUNT];    // the last closed frame
+    double   total[STAGE_COUNT];   // every closed frame since stats_reset()
+    unsigned long long bytes, writes;          // last frame's output
+    unsigned long long bytes_at, writes_at;    // running output totals at its end
+    long     frames;
+    double   begin, end;           // start of the open frame, end of the last
+    double   work[STATS_RING];     // frame time without sleep
+    double   gap[STATS_RING];      // end of the frame before to this one's end
+    int      ring, nring;
+    double   fps, p50, p99;        // achieved rate; work time percentiles, seconds
+} Stats;
+extern Stats g_stats;
+
+void   stats_reset(void);
+void   stats_frame_begin(void);
+/* close the frame; bytes/writes are the output's running totals */
+void   stats_frame_end(unsigned long long bytes, unsigned long long writes);
+static inline void stats_add(Stage s, double sec){ g_stats.stage[s] += sec; }
+/* seconds the open frame has so far; callers that time a span holding
+   self-timed stages subtract its growth */
+static inline double stats_open(void){
+    double sum=0;
+    for(int k=0;k<STAGE_COUNT;k++) sum+=g_stats.stage[k];
+    return sum;
+}
+/* add now - since to s and return now, to time the next stage from */
+double stats_lap(Stage s, double since);
+
+/* --stats-file: a row per closed frame, json lines when the name ends in
+   .json or .jsonl, csv otherwise */
+FILE  *stats_log_open(const char *path);
+void   stats_log_frame(FILE *f, double t);
+#endif
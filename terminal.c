@@ -4,12 +4,54 @@
 #include <termios.h>
 #include <unistd.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
 #include <sys/ioctl.h>
 
 static struct termios g_old;
 static int g_raw = 0;
 volatile sig_atomic_t g_resized = 0;
 
+TermOut g_term_out;
+static int g_out_fd = STDOUT_FILENO;
+static char *g_buf; static size_t g_buf_len, g_buf_cap;
+
+void term_sink_fd(int fd){ term_flush(); g_out_fd = fd; }
+const char *term_mem(size_t *len){ *len = g_buf_len; return g_buf ? g_buf : ""; }
+void term_mem_clear(void){ g_buf_len = 0; }
+
+void term_write(const void *buf, size_t n){
+    g_term_out.bytes += n;
+    if(g_buf_len + n > g_buf_cap){
+        size_t cap = g_buf_cap ? g_buf_cap : 1<<16;
+        while(cap < g_buf_len + n) cap *= 2;
+        char *m = (char*)realloc(g_buf, cap);
+        if(!m){ term_flush(); if(g_out_fd>=0){ ssize_t w=write(g_out_fd,buf,n); (void)w; g_term_out.writes++; } return; }
+        g_buf = m; g_buf_cap = cap;
+    }
+    memcpy(g_buf + g_buf_len, buf, n); g_buf_len += n;
+}
+
+// stdin's O_NONBLOCK can reach the tty's stdout too, so wait out EAGAIN
+void term_flush(void){
+    if(g_out_fd < 0) return;   // memory: kept for term_mem()
+    size_t off = 0;
+    while(off < g_buf_len){
+        ssize_t w = write(g_out_fd, g_buf + off, g_buf_len - off);
+        g_term_out.writes++;
+        if(w > 0){ off += (size_t)w; continue; }
+        if(w < 0 && errno == EINTR) continue;
+        if(w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)){
+            struct pollfd p = { .fd=g_out_fd, .events=POLLOUT, .revents=0 };
+            if(poll(&p,1,1000) > 0) continue;
+        }
+        break;   // the tty is gone or stuck: drop the rest
+    }
+    g_buf_len = 0;
+}
+
 void term_raw_on(void){
     if(g_raw) return;
     struct termios t;
@@ -25,19 +67,19 @@ void term_raw_off(void){
     tcsetattr(STDIN_FILENO,TCSANOW,&g_old);
     g_raw=0;
 }
-void term_hide_cursor(void){ ssize_t w=write(STDOUT_FILENO,"\x1b[?25l",6); (void)w; }
-void term_show_cursor(void){ ssize_t w=write(STDOUT_FILENO,"\x1b[?25h",6); (void)w; }
-void term_clear(void){ ssize_t w=write(STDOUT_FILENO,"\x1b[2J\x1b[H",7); (void)w; }
+void term_hide_cursor(void){ term_write("\x1b[?25l",6); }
+void term_show_cursor(void){ term_write("\x1b[?25h",6); }
+void term_clear(void){ term_write("\x1b[2J\x1b[H",7); }
 void term_move(int row,int col){
     char esc[32];
     int n=snprintf(esc,sizeof(esc),"\x1b[%d;%dH", row, col);
-    ssize_t w=write(STDOUT_FILENO,esc,n); (void)w;
+    term_write(esc,(size_t)n);
 }
-void term_clear_line(void){ ssize_t w=write(STDOUT_FILENO,"\x1b[2K",4); (void)w; }
-void term_alt_on(void){ ssize_t w=write(STDOUT_FILENO, "\x1b[?1049h", 8); (void)w; }
-void term_alt_off(void){ ssize_t w=write(STDOUT_FILENO, "\x1b[?1049l", 8); (void)w; }
-void term_wrap_off(void){ ssize_t w=write(STDOUT_FILENO, "\x1b[?7l", 5); (void)w; }
-void term_wrap_on(void){ ssize_t w=write(STDOUT_FILENO, "\x1b[?7h", 5); (void)w; }
+void term_clear_line(void){ term_write("\x1b[2K",4); }
+void term_alt_on(void){ term_write("\x1b[?1049h",8); }
+void term_alt_off(void){ term_write("\x1b[?1049l",8); }
+void term_wrap_off(void){ term_write("\x1b[?7l",5); }
+void term_wrap_on(void){ term_write("\x1b[?7h",5); }
 
 void on_winch(int sig){ (void)sig; g_resized=1; }
 void get_tty_size(int *w,int *h){
@@ -1,6 +1,22 @@
 #ifndef TERMINAL_H
 #define TERMINAL_H
 #include <signal.h>
+#include <stddef.h>
+
+/* all screen output goes through term_write, which collects it until
+   term_flush() hands it to stdout in as few write(2)s as the fd takes.
+   term_sink_fd() points that at another fd, or with -1 keeps it in memory
+   (term_mem) for headless runs */
+typedef struct {
+    unsigned long long bytes, writes;   // running totals: bytes written, write(2) calls
+} TermOut;
+extern TermOut g_term_out;
+void term_write(const void *buf, size_t n);
+void term_flush(void);
+void term_sink_fd(int fd);
+const char *term_mem(size_t *len);
+void term_mem_clear(void);
+
 void term_raw_on(void);
 void term_raw_off(void);
 void term_hide_cursor(void);
@@ -0,0 +1,23 @@
+#ifndef VEC_H
+#define VEC_H
+/* GCC vector extension lanes shared by the batched kernels (fractal, sim,
+   dither, noise, lyapunov). FRAC_VEC_BYTES picks the width: 32 with AVX,
+   16 (SSE2 / NEON) otherwise; -DFRAC_VEC_BYTES=... overrides. other
+   compilers get no types here and the kernels' scalar fallbacks */
+#if defined(__GNUC__)
+#ifndef FRAC_VEC_BYTES
+#if defined(__AVX__)
+#define FRAC_VEC_BYTES 32
+#else
+#define FRAC_VEC_BYTES 16
+#endif
+#endif
+typedef float     vf32 __attribute__((vector_size(FRAC_VEC_BYTES)));
+typedef int       vi32 __attribute__((vector_size(FRAC_VEC_BYTES)));
+typedef double    vf64 __attribute__((vector_size(FRAC_VEC_BYTES)));
+typedef long long vi64 __attribute__((vector_size(FRAC_VEC_BYTES)));
+// clear the sign bits (-0.0 in every lane is the mask)
+#define VABS_F(v) ((vf32)((vi32)(v) & ~(vi32)(-(vf32){ 0 })))
+#define VABS_D(v) ((vf64)((vi64)(v) & ~(vi64)(-(vf64){ 0 })))
+#endif
+#endif